@@ -238,6 +238,14 @@ vp8_multi_resolution_encoder.SRCS       += vpx_ports/msvc.h
 vp8_multi_resolution_encoder.SRCS       += $(LIBYUV_SRCS)
 vp8_multi_resolution_encoder.GUID        = 04f8738e-63c8-423b-90fa-7c2703a374de
 vp8_multi_resolution_encoder.DESCRIPTION = VP8 Multiple-resolution Encoding
+EXAMPLES-$(CONFIG_VP9_ENCODER)          += vp9_multi_resolution_encoder.c
+vp9_multi_resolution_encoder.SRCS       += ivfenc.h ivfenc.c
+vp9_multi_resolution_encoder.SRCS       += tools_common.h tools_common.c
+vp9_multi_resolution_encoder.SRCS       += video_writer.h video_writer.c
+vp9_multi_resolution_encoder.SRCS       += vpx_ports/msvc.h
+vp9_multi_resolution_encoder.SRCS       += $(LIBYUV_SRCS)
+vp9_multi_resolution_encoder.GUID        = 2f4b3c2a-7d1e-4b6e-9c85-3a0e6d9f1b47
+vp9_multi_resolution_encoder.DESCRIPTION = VP9 Multiple-resolution Encoding
 endif
 endif
 
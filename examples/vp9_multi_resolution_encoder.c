@@ -0,0 +1,214 @@
+/*
+ *  Copyright (c) 2017 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * This is an example demonstrating multi-resolution encoding in VP9.
+ * The I420 input is down-sampled once per resolution and every resolution
+ * is coded into its own IVF file. The encoders are run in one
+ * vpx_codec_enc_init_multi() context: the lowest resolution is coded first
+ * and each higher resolution seeds its motion search with the scaled motion
+ * of the resolution below it. Passing 1 as the last argument runs the same
+ * ladder with independent encoders, which gives the baseline encode time.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./vpx_config.h"
+#include "../tools_common.h"
+#include "../video_writer.h"
+#include "vpx_ports/vpx_timer.h"
+#include "vpx/vp8cx.h"
+#include "vpx/vpx_encoder.h"
+
+/* This example uses the scaler function in libyuv. */
+#include "third_party/libyuv/include/libyuv/scale.h"
+
+/* Number of encoders (spatial resolutions) used in this example. */
+#define NUM_ENCODERS 3
+
+static const char *exec_name;
+
+void usage_exit(void) {
+  fprintf(stderr,
+          "Usage: %s <width> <height> <infile> <outfile-prefix> "
+          "<speed> <independent>\n",
+          exec_name);
+  exit(EXIT_FAILURE);
+}
+
+/* Writes the packets of |codec| and returns whether it produced any. */
+static int write_packets(vpx_codec_ctx_t *codec, VpxVideoWriter *writer) {
+  int got_pkts = 0;
+  vpx_codec_iter_t iter = NULL;
+  const vpx_codec_cx_pkt_t *pkt = NULL;
+
+  while ((pkt = vpx_codec_get_cx_data(codec, &iter)) != NULL) {
+    got_pkts = 1;
+    if (pkt->kind == VPX_CODEC_CX_FRAME_PKT) {
+      if (!vpx_video_writer_write_frame(writer, pkt->data.frame.buf,
+                                        pkt->data.frame.sz,
+                                        pkt->data.frame.pts))
+        die_codec(codec, "Failed to write compressed frame");
+    }
+  }
+  return got_pkts;
+}
+
+/* Codes |img| (NULL to flush) at every resolution. A multi-resolution
+ * context codes all of them from one call on the highest resolution, which
+ * takes the array of down-sampled images, lowest resolution last.
+ */
+static int encode_frame(vpx_codec_ctx_t *codec, vpx_image_t *img,
+                        int frame_index, int independent,
+                        VpxVideoWriter **writer) {
+  int got_pkts = 0;
+  int i;
+
+  if (!independent &&
+      vpx_codec_encode(&codec[0], img, frame_index, 1, 0, VPX_DL_REALTIME))
+    die_codec(&codec[0], "Failed to encode frame");
+  for (i = NUM_ENCODERS - 1; i >= 0; i--) {
+    if (independent &&
+        vpx_codec_encode(&codec[i], img ? &img[i] : NULL, frame_index, 1, 0,
+                         VPX_DL_REALTIME))
+      die_codec(&codec[i], "Failed to encode frame");
+    got_pkts |= write_packets(&codec[i], writer[i]);
+  }
+  return got_pkts;
+}
+
+int main(int argc, char **argv) {
+  FILE *infile;
+  VpxVideoWriter *writer[NUM_ENCODERS];
+  vpx_codec_ctx_t codec[NUM_ENCODERS];
+  vpx_codec_enc_cfg_t cfg[NUM_ENCODERS];
+  vpx_image_t raw[NUM_ENCODERS];
+  /* dsf[i] is the down-sampling factor from resolution i to i + 1. */
+  vpx_rational_t dsf[NUM_ENCODERS] = { { 2, 1 }, { 2, 1 }, { 1, 1 } };
+  const unsigned int target_bitrate[NUM_ENCODERS] = { 1000, 400, 150 };
+  struct vpx_usec_timer timer;
+  int64_t cx_time = 0;
+  int frame_count = 0;
+  int speed;
+  int independent;
+  int i;
+
+  exec_name = argv[0];
+  if (argc != 7) die("Invalid number of arguments");
+
+  cfg[0].g_w = (unsigned int)strtol(argv[1], NULL, 0);
+  cfg[0].g_h = (unsigned int)strtol(argv[2], NULL, 0);
+  speed = (int)strtol(argv[5], NULL, 0);
+  independent = (int)strtol(argv[6], NULL, 0);
+  if (cfg[0].g_w < 16 || cfg[0].g_w % 2 || cfg[0].g_h < 16 || cfg[0].g_h % 2)
+    die("Invalid resolution: %dx%d", cfg[0].g_w, cfg[0].g_h);
+
+  if (!(infile = fopen(argv[3], "rb")))
+    die("Failed to open %s for reading", argv[3]);
+
+  for (i = 0; i < NUM_ENCODERS; i++) {
+    const unsigned int w = cfg[0].g_w;
+    const unsigned int h = cfg[0].g_h;
+    VpxVideoInfo info = { 0, 0, 0, { 0, 0 } };
+    char filename[256];
+
+    if (vpx_codec_enc_config_default(vpx_codec_vp9_cx(), &cfg[i], 0))
+      die("Failed to get default codec config.");
+    if (i == 0) {
+      cfg[0].g_w = w;
+      cfg[0].g_h = h;
+    } else {
+      /* Round up and keep the dimensions even. */
+      cfg[i].g_w = (cfg[i - 1].g_w * dsf[i - 1].den + dsf[i - 1].num - 1) /
+                   dsf[i - 1].num;
+      cfg[i].g_h = (cfg[i - 1].g_h * dsf[i - 1].den + dsf[i - 1].num - 1) /
+                   dsf[i - 1].num;
+      cfg[i].g_w += cfg[i].g_w % 2;
+      cfg[i].g_h += cfg[i].g_h % 2;
+    }
+    cfg[i].g_timebase.num = 1;
+    cfg[i].g_timebase.den = 30;
+    cfg[i].g_lag_in_frames = 0;
+    cfg[i].g_error_resilient = 1;
+    cfg[i].rc_end_usage = VPX_CBR;
+    cfg[i].rc_target_bitrate = target_bitrate[i];
+    cfg[i].rc_dropframe_thresh = 0;
+    cfg[i].rc_resize_allowed = 0;
+    cfg[i].kf_max_dist = 3000;
+
+    if (!vpx_img_alloc(&raw[i], VPX_IMG_FMT_I420, cfg[i].g_w, cfg[i].g_h, 32))
+      die("Failed to allocate image %dx%d", cfg[i].g_w, cfg[i].g_h);
+
+    info.codec_fourcc = VP9_FOURCC;
+    info.frame_width = cfg[i].g_w;
+    info.frame_height = cfg[i].g_h;
+    info.time_base.numerator = cfg[i].g_timebase.num;
+    info.time_base.denominator = cfg[i].g_timebase.den;
+    snprintf(filename, sizeof(filename), "%s_%dx%d.ivf", argv[4], cfg[i].g_w,
+             cfg[i].g_h);
+    writer[i] = vpx_video_writer_open(filename, kContainerIVF, &info);
+    if (!writer[i]) die("Failed to open %s for writing", filename);
+  }
+
+  if (independent) {
+    for (i = 0; i < NUM_ENCODERS; i++) {
+      if (vpx_codec_enc_init(&codec[i], vpx_codec_vp9_cx(), &cfg[i], 0))
+        die_codec(&codec[i], "Failed to initialize encoder");
+    }
+  } else {
+    if (vpx_codec_enc_init_multi(&codec[0], vpx_codec_vp9_cx(), &cfg[0],
+                                 NUM_ENCODERS, 0, &dsf[0]))
+      die_codec(&codec[0], "Failed to initialize encoder");
+  }
+  for (i = 0; i < NUM_ENCODERS; i++) {
+    if (vpx_codec_control(&codec[i], VP8E_SET_CPUUSED, speed))
+      die_codec(&codec[i], "Failed to set cpu_used");
+  }
+
+  while (vpx_img_read(&raw[0], infile)) {
+    /* The down-sampling is done once and shared by both modes. */
+    for (i = 1; i < NUM_ENCODERS; i++) {
+      I420Scale(raw[i - 1].planes[VPX_PLANE_Y], raw[i - 1].stride[VPX_PLANE_Y],
+                raw[i - 1].planes[VPX_PLANE_U], raw[i - 1].stride[VPX_PLANE_U],
+                raw[i - 1].planes[VPX_PLANE_V], raw[i - 1].stride[VPX_PLANE_V],
+                raw[i - 1].d_w, raw[i - 1].d_h, raw[i].planes[VPX_PLANE_Y],
+                raw[i].stride[VPX_PLANE_Y], raw[i].planes[VPX_PLANE_U],
+                raw[i].stride[VPX_PLANE_U], raw[i].planes[VPX_PLANE_V],
+                raw[i].stride[VPX_PLANE_V], raw[i].d_w, raw[i].d_h,
+                kFilterBox);
+    }
+
+    vpx_usec_timer_start(&timer);
+    encode_frame(codec, raw, frame_count, independent, writer);
+    vpx_usec_timer_mark(&timer);
+    cx_time += vpx_usec_timer_elapsed(&timer);
+    frame_count++;
+  }
+
+  /* Flush the encoders. */
+  while (encode_frame(codec, NULL, -1, independent, writer)) {
+  }
+
+  printf("Processed %d frames in %s mode: %.1f ms, %.2f ms/frame\n",
+         frame_count, independent ? "independent" : "multi-resolution",
+         cx_time / 1000.0, frame_count ? cx_time / 1000.0 / frame_count : 0.0);
+
+  fclose(infile);
+  for (i = 0; i < NUM_ENCODERS; i++) {
+    if (vpx_codec_destroy(&codec[i]))
+      die_codec(&codec[i], "Failed to destroy codec");
+    vpx_img_free(&raw[i]);
+    vpx_video_writer_close(writer[i]);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -138,6 +138,21 @@ TEST(DecodeAPI, Vp9InvalidDecode) {
   EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
 }
 
+TEST(DecodeAPI, Vp9FastPreview) {
+  vpx_codec_ctx_t dec;
+  EXPECT_EQ(VPX_CODEC_OK,
+            vpx_codec_dec_init(&dec, &vpx_codec_vp9_dx_algo, NULL, 0));
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&dec, VP9_SET_FAST_PREVIEW, -1));
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&dec, VP9_SET_FAST_PREVIEW, 3));
+  for (int level = 2; level >= 0; --level) {
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(&dec, VP9_SET_FAST_PREVIEW, level));
+  }
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+}
+
 TEST(DecodeAPI, Vp9PeekSI) {
   const vpx_codec_iface_t *const codec = &vpx_codec_vp9_dx_algo;
   // The first 9 bytes are valid and the rest of the bytes are made up. Until
@@ -18,6 +18,7 @@
 #include "vpx/vpx_integer.h"
 #include "vpx_dsp/bitreader.h"
 #include "vpx_dsp/bitwriter.h"
+#include "vpx_ports/vpx_timer.h"
 
 using libvpx_test::ACMRandom;
 
@@ -87,3 +88,71 @@ TEST(VP9, TestBitIO) {
     }
   }
 }
+
+TEST(VP9, DISABLED_BitReaderSpeed) {
+  const int kBitsToTest = 1 << 20;
+  const int kRuns = 100;
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  uint8_t *const probas = new uint8_t[kBitsToTest];
+  uint8_t *const bits = new uint8_t[kBitsToTest];
+  uint8_t *const buffer = new uint8_t[kBitsToTest];
+
+  // A mix of skewed and even probabilities, with the bits drawn from them,
+  // roughly like the coefficient tokens of a mid-rate stream.
+  for (int i = 0; i < kBitsToTest; ++i) {
+    probas[i] = (i & 3) ? 1 + rnd(254) : 128 + rnd(2) * 96;
+    bits[i] = rnd(256) >= probas[i];
+  }
+  vpx_writer bw;
+  vpx_start_encode(&bw, buffer);
+  for (int i = 0; i < kBitsToTest; ++i) vpx_write(&bw, bits[i], probas[i]);
+  vpx_stop_encode(&bw);
+
+  int errors = 0;
+  vpx_usec_timer timer;
+  vpx_usec_timer_start(&timer);
+  for (int run = 0; run < kRuns; ++run) {
+    vpx_reader br;
+    vpx_reader_init(&br, buffer, bw.pos, NULL, NULL);
+    for (int i = 0; i < kBitsToTest; ++i)
+      errors += vpx_read(&br, probas[i]) != bits[i];
+  }
+  vpx_usec_timer_mark(&timer);
+  EXPECT_EQ(0, errors);
+  printf("vpx_read: %d bits in %d us\n", kBitsToTest * kRuns,
+         static_cast<int>(vpx_usec_timer_elapsed(&timer)));
+
+  // The same buffer read as 8 bit literals and as 4 bit symbols through a
+  // balanced tree.
+  vpx_usec_timer_start(&timer);
+  for (int run = 0; run < kRuns; ++run) {
+    vpx_reader br;
+    vpx_reader_init(&br, buffer, bw.pos, NULL, NULL);
+    for (int i = 0; i < kBitsToTest; i += 8)
+      errors += vpx_read_literal(&br, 8) < 0;
+  }
+  vpx_usec_timer_mark(&timer);
+  printf("vpx_read_literal: %d bits in %d us\n", kBitsToTest * kRuns,
+         static_cast<int>(vpx_usec_timer_elapsed(&timer)));
+
+  static const vpx_tree_index kTree[30] = { 2,   16,  4,   10,  6,   8,
+                                            -0,  -1,  -2,  -3,  12,  14,
+                                            -4,  -5,  -6,  -7,  18,  24,
+                                            20,  22,  -8,  -9,  -10, -11,
+                                            26,  28,  -12, -13, -14, -15 };
+  vpx_usec_timer_start(&timer);
+  for (int run = 0; run < kRuns; ++run) {
+    vpx_reader br;
+    vpx_reader_init(&br, buffer, bw.pos, NULL, NULL);
+    for (int i = 0; i < kBitsToTest; i += 4)
+      errors += vpx_read_tree(&br, kTree, probas) < 0;
+  }
+  vpx_usec_timer_mark(&timer);
+  printf("vpx_read_tree: %d bits in %d us\n", kBitsToTest * kRuns,
+         static_cast<int>(vpx_usec_timer_elapsed(&timer)));
+  EXPECT_EQ(0, errors);
+
+  delete[] buffer;
+  delete[] bits;
+  delete[] probas;
+}
@@ -0,0 +1,85 @@
+/*
+ *  Copyright (c) 2017 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/i420_video_source.h"
+#include "test/util.h"
+
+namespace {
+
+class EarlyPackingTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWith3Params<int, int, int> {
+ protected:
+  EarlyPackingTest()
+      : EncoderTest(GET_PARAM(0)), early_packing_(0), cpu_used_(GET_PARAM(1)),
+        tile_cols_(GET_PARAM(2)), threads_(GET_PARAM(3)), bytes_(0),
+        frames_(0) {}
+
+  virtual ~EarlyPackingTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(::libvpx_test::kRealTime);
+    cfg_.g_lag_in_frames = 0;
+    cfg_.g_threads = threads_;
+    cfg_.rc_end_usage = VPX_CBR;
+    cfg_.rc_target_bitrate = 500;
+    cfg_.kf_max_dist = 10;
+  }
+
+  virtual void BeginPassHook(unsigned int /*pass*/) {
+    bytes_ = 0;
+    frames_ = 0;
+  }
+
+  virtual void PreEncodeFrameHook(::libvpx_test::VideoSource *video,
+                                  ::libvpx_test::Encoder *encoder) {
+    if (video->frame() == 0) {
+      encoder->Control(VP8E_SET_CPUUSED, cpu_used_);
+      encoder->Control(VP9E_SET_TILE_COLUMNS, tile_cols_);
+      encoder->Control(VP9E_SET_EARLY_PACKING, early_packing_);
+    }
+  }
+
+  virtual void FramePktHook(const vpx_codec_cx_pkt_t *pkt) {
+    bytes_ += pkt->data.frame.sz;
+    ++frames_;
+  }
+
+  int early_packing_;
+  int cpu_used_;
+  int tile_cols_;
+  int threads_;
+  size_t bytes_;
+  int frames_;
+};
+
+// Frames packed as they are encoded decode without mismatch, and cost at most
+// a few percent over frames packed after encoding.
+TEST_P(EarlyPackingTest, MatchesDecoder) {
+  ::libvpx_test::I420VideoSource video("hantro_collage_w352h288.yuv", 352, 288,
+                                       30, 1, 0, 20);
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  const size_t bytes_off = bytes_;
+
+  early_packing_ = 1;
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  EXPECT_EQ(20, frames_);
+  EXPECT_LE(bytes_, bytes_off + bytes_off / 20);
+}
+
+VP9_INSTANTIATE_TEST_CASE(EarlyPackingTest,
+                          ::testing::Values(5, 8),   // cpu_used
+                          ::testing::Values(0, 1),   // tile_columns
+                          ::testing::Values(1, 2));  // threads
+}  // namespace
@@ -0,0 +1,161 @@
+/*
+ *  Copyright (c) 2017 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/i420_video_source.h"
+#include "test/md5_helper.h"
+#include "test/util.h"
+#include "vpx/vp8cx.h"
+#include "vpx/vp8dx.h"
+
+namespace {
+
+const int kWidth = 352;
+const int kHeight = 288;
+const int kStepDownFrame = 3;
+const int kStepUpFrame = 6;
+const int kNumBuffers = 8;
+
+class FrameBufferPoolTest : public ::libvpx_test::EncoderTest,
+                            public ::libvpx_test::CodecTestWithParam<int> {
+ protected:
+  FrameBufferPoolTest()
+      : EncoderTest(GET_PARAM(0)), prealloc_(GET_PARAM(1) != 0), frame_(0),
+        first_bytes_(0) {
+    vpx_codec_dec_cfg_t cfg = vpx_codec_dec_cfg_t();
+    decoder_ = codec_->CreateDecoder(cfg, 0);
+    ref_decoder_ = codec_->CreateDecoder(cfg, 0);
+    if (prealloc_) {
+      vpx_frame_buffer_prealloc_t prealloc = { kWidth, kHeight,
+                                               VPX_IMG_FMT_I420, kNumBuffers };
+      decoder_->Control(VP9_SET_FRAME_BUFFER_PREALLOC, &prealloc);
+    }
+  }
+
+  virtual ~FrameBufferPoolTest() {
+    delete decoder_;
+    delete ref_decoder_;
+  }
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(libvpx_test::kRealTime);
+    cfg_.g_lag_in_frames = 0;
+  }
+
+  virtual void PreEncodeFrameHook(libvpx_test::VideoSource *video,
+                                  libvpx_test::Encoder *encoder) {
+    if (video->frame() == 0) encoder->Control(VP8E_SET_CPUUSED, 6);
+    if (video->frame() == kStepDownFrame) {
+      struct vpx_scaling_mode mode = { VP8E_ONETWO, VP8E_ONETWO };
+      encoder->Control(VP8E_SET_SCALEMODE, &mode);
+    }
+    if (video->frame() == kStepUpFrame) {
+      struct vpx_scaling_mode mode = { VP8E_NORMAL, VP8E_NORMAL };
+      encoder->Control(VP8E_SET_SCALEMODE, &mode);
+    }
+  }
+
+  const vpx_image_t *Decode(::libvpx_test::Decoder *dec,
+                            const vpx_codec_cx_pkt_t *pkt) {
+    const vpx_codec_err_t res = dec->DecodeFrame(
+        reinterpret_cast<uint8_t *>(pkt->data.frame.buf), pkt->data.frame.sz);
+    if (res != VPX_CODEC_OK) {
+      abort_ = true;
+      EXPECT_EQ(VPX_CODEC_OK, res) << dec->DecodeError();
+      return NULL;
+    }
+    return dec->GetDxData().Next();
+  }
+
+  virtual void FramePktHook(const vpx_codec_cx_pkt_t *pkt) {
+    const vpx_image_t *const img = Decode(decoder_, pkt);
+    const vpx_image_t *const ref_img = Decode(ref_decoder_, pkt);
+    if (img == NULL || ref_img == NULL) return;
+
+    ::libvpx_test::MD5 md5, ref_md5;
+    md5.Add(img);
+    ref_md5.Add(ref_img);
+    EXPECT_STREQ(ref_md5.Get(), md5.Get()) << "frame " << frame_;
+
+    vpx_frame_buffer_stats_t stats;
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(decoder_->GetDecoder(),
+                                VP9D_GET_FRAME_BUFFER_STATS, &stats));
+    EXPECT_LE(stats.current_bytes, stats.peak_bytes);
+    EXPECT_LE(stats.num_in_use, stats.num_allocated);
+    EXPECT_GT(stats.num_in_use, 0);
+    if (frame_ == 0) {
+      first_bytes_ = stats.current_bytes;
+      if (prealloc_) {
+        EXPECT_EQ(kNumBuffers, stats.num_allocated);
+        EXPECT_GE(stats.current_bytes,
+                  static_cast<size_t>(kNumBuffers * kWidth * kHeight * 3 / 2));
+      }
+    } else if (prealloc_) {
+      // Every frame fits in the buffers allocated up front.
+      EXPECT_EQ(first_bytes_, stats.current_bytes) << "frame " << frame_;
+    }
+    EXPECT_EQ(stats.peak_bytes, stats.current_bytes) << "frame " << frame_;
+    ++frame_;
+  }
+
+  bool prealloc_;
+  int frame_;
+  size_t first_bytes_;
+  ::libvpx_test::Decoder *decoder_;
+  ::libvpx_test::Decoder *ref_decoder_;
+};
+
+// Decodes a stream that changes its frame size. With preallocated buffers the
+// frame buffer memory stays the same, and the output matches a decoder
+// without them.
+TEST_P(FrameBufferPoolTest, ResizeReusesBuffers) {
+  cfg_.rc_target_bitrate = 300;
+  libvpx_test::I420VideoSource video("hantro_collage_w352h288.yuv", kWidth,
+                                     kHeight, 30, 1, 0, 10);
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  EXPECT_EQ(10, frame_);
+}
+
+TEST(FrameBufferPoolAPI, InvalidParams) {
+  vpx_codec_ctx_t dec;
+  vpx_frame_buffer_prealloc_t prealloc = { kWidth, kHeight, VPX_IMG_FMT_I420,
+                                           kNumBuffers };
+  vpx_frame_buffer_stats_t stats;
+
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_dec_init(&dec, &vpx_codec_vp9_dx_algo, NULL, 0));
+  EXPECT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&dec, VP9D_GET_FRAME_BUFFER_STATS, &stats));
+  EXPECT_EQ(0u, stats.current_bytes);
+  EXPECT_EQ(0, stats.num_allocated);
+
+  prealloc.num_buffers = VP9_MAXIMUM_REF_BUFFERS + VPX_MAXIMUM_WORK_BUFFERS + 1;
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&dec, VP9_SET_FRAME_BUFFER_PREALLOC, &prealloc));
+  prealloc.num_buffers = kNumBuffers;
+  prealloc.width = 0;
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&dec, VP9_SET_FRAME_BUFFER_PREALLOC, &prealloc));
+  prealloc.width = kWidth;
+  prealloc.fmt = VPX_IMG_FMT_YV12;
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&dec, VP9_SET_FRAME_BUFFER_PREALLOC, &prealloc));
+  prealloc.fmt = VPX_IMG_FMT_NONE;
+  EXPECT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&dec, VP9_SET_FRAME_BUFFER_PREALLOC, &prealloc));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+}
+
+VP9_INSTANTIATE_TEST_CASE(FrameBufferPoolTest, ::testing::Range(0, 2));
+}  // namespace
@@ -0,0 +1,193 @@
+/*
+ *  Copyright (c) 2017 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <cstring>
+#include <vector>
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/i420_video_source.h"
+#include "test/md5_helper.h"
+#include "test/util.h"
+#include "vpx/vp8cx.h"
+#include "vpx/vp8dx.h"
+
+namespace {
+
+const int kWidth = 704;
+const int kHeight = 144;
+
+// Simulates a frame arriving over the network: the decoder's buffer holds
+// garbage until the wait callback copies the bytes it asks for into it.
+struct StreamState {
+  const uint8_t *frame;
+  uint8_t *buffer;
+  size_t frame_size;
+  size_t arrived;
+  size_t fail_after;
+  std::vector<size_t> waits;
+};
+
+int WaitForInput(void *wait_state, size_t size) {
+  StreamState *const state = static_cast<StreamState *>(wait_state);
+  state->waits.push_back(size);
+  if (size > state->frame_size || size > state->fail_after) return -1;
+  if (size > state->arrived) {
+    memcpy(state->buffer + state->arrived, state->frame + state->arrived,
+           size - state->arrived);
+    state->arrived = size;
+  }
+  return 0;
+}
+
+class InputWaitTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWith2Params<int, int> {
+ protected:
+  InputWaitTest()
+      : EncoderTest(GET_PARAM(0)), threads_(GET_PARAM(1)),
+        log2_tile_rows_(GET_PARAM(2)), frame_(0), frames_streamed_(0) {
+    vpx_codec_dec_cfg_t cfg = vpx_codec_dec_cfg_t();
+    cfg.threads = threads_;
+    ref_dec_ = codec_->CreateDecoder(cfg, 0);
+    stream_dec_ = codec_->CreateDecoder(cfg, 0);
+    vpx_input_wait_init init = { WaitForInput, &state_ };
+    stream_dec_->Control(VP9D_SET_INPUT_WAIT, &init);
+  }
+
+  virtual ~InputWaitTest() {
+    delete ref_dec_;
+    delete stream_dec_;
+  }
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(libvpx_test::kRealTime);
+    cfg_.g_lag_in_frames = 0;
+  }
+
+  virtual void PreEncodeFrameHook(libvpx_test::VideoSource *video,
+                                  libvpx_test::Encoder *encoder) {
+    if (video->frame() == 0) {
+      encoder->Control(VP8E_SET_CPUUSED, 6);
+      encoder->Control(VP9E_SET_TILE_COLUMNS, 1);
+      encoder->Control(VP9E_SET_TILE_ROWS, log2_tile_rows_);
+    }
+  }
+
+  virtual void FramePktHook(const vpx_codec_cx_pkt_t *pkt) {
+    const uint8_t *const frame =
+        reinterpret_cast<const uint8_t *>(pkt->data.frame.buf);
+    const size_t frame_size = pkt->data.frame.sz;
+    std::vector<uint8_t> buffer(frame_size, 0xff);
+    state_.frame = frame;
+    state_.buffer = &buffer[0];
+    state_.frame_size = frame_size;
+    state_.arrived = 0;
+    state_.fail_after = frame_size;
+    state_.waits.clear();
+
+    ASSERT_EQ(VPX_CODEC_OK, ref_dec_->DecodeFrame(frame, frame_size));
+    const vpx_codec_err_t res =
+        stream_dec_->DecodeFrame(&buffer[0], frame_size);
+    ASSERT_EQ(VPX_CODEC_OK, res) << stream_dec_->DecodeError();
+
+    // The header, the compressed header and each tile are waited for in turn,
+    // apart from the parts that arrived with the header.
+    ASSERT_GE(state_.waits.size(), 2u) << "frame " << frame_;
+    if (state_.waits.size() > 3) ++frames_streamed_;
+    for (size_t i = 1; i < state_.waits.size(); ++i)
+      EXPECT_LT(state_.waits[i - 1], state_.waits[i]) << "frame " << frame_;
+    EXPECT_EQ(frame_size, state_.waits.back()) << "frame " << frame_;
+
+    const vpx_image_t *const ref_img = ref_dec_->GetDxData().Next();
+    const vpx_image_t *const img = stream_dec_->GetDxData().Next();
+    ASSERT_TRUE(ref_img != NULL && img != NULL);
+    ::libvpx_test::MD5 ref_md5, md5;
+    ref_md5.Add(ref_img);
+    md5.Add(img);
+    EXPECT_STREQ(ref_md5.Get(), md5.Get()) << "frame " << frame_;
+    ++frame_;
+  }
+
+  int threads_;
+  int log2_tile_rows_;
+  int frame_;
+  int frames_streamed_;
+  StreamState state_;
+  ::libvpx_test::Decoder *ref_dec_;
+  ::libvpx_test::Decoder *stream_dec_;
+};
+
+// Every byte reaches the decoder's buffer only when the decoder waits for it,
+// and the output matches a decoder given the whole frame.
+TEST_P(InputWaitTest, MatchesWholeFrameDecode) {
+  cfg_.rc_target_bitrate = 500;
+  libvpx_test::I420VideoSource video("hantro_collage_w352h288.yuv", kWidth,
+                                     kHeight, 30, 1, 0, 10);
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  EXPECT_EQ(10, frame_);
+  EXPECT_GT(frames_streamed_, 0);
+}
+
+TEST(InputWaitAPI, FailedWait) {
+  libvpx_test::I420VideoSource video("hantro_collage_w352h288.yuv", kWidth,
+                                     kHeight, 30, 1, 0, 1);
+  vpx_codec_enc_cfg_t cfg;
+  vpx_codec_ctx_t enc, dec;
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_enc_config_default(&vpx_codec_vp9_cx_algo, &cfg, 0));
+  cfg.g_w = kWidth;
+  cfg.g_h = kHeight;
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_enc_init(&enc, &vpx_codec_vp9_cx_algo, &cfg, 0));
+  video.Begin();
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_encode(&enc, video.img(), video.pts(),
+                                           video.duration(), 0,
+                                           VPX_DL_REALTIME));
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_encode(&enc, NULL, 0, 0, 0, VPX_DL_REALTIME));
+  vpx_codec_iter_t iter = NULL;
+  const vpx_codec_cx_pkt_t *pkt = vpx_codec_get_cx_data(&enc, &iter);
+  ASSERT_TRUE(pkt != NULL);
+  ASSERT_EQ(VPX_CODEC_CX_FRAME_PKT, pkt->kind);
+
+  const uint8_t *const frame =
+      reinterpret_cast<const uint8_t *>(pkt->data.frame.buf);
+  const size_t frame_size = pkt->data.frame.sz;
+  std::vector<uint8_t> buffer(frame_size, 0xff);
+  StreamState state;
+  state.frame = frame;
+  state.buffer = &buffer[0];
+  state.frame_size = frame_size;
+  state.arrived = 0;
+  state.fail_after = frame_size / 2;
+  vpx_input_wait_init init = { WaitForInput, &state };
+
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_dec_init(&dec, &vpx_codec_vp9_dx_algo, NULL, 0));
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(&dec, VP9D_SET_INPUT_WAIT, &init));
+  EXPECT_EQ(VPX_CODEC_CORRUPT_FRAME,
+            vpx_codec_decode(&dec, &buffer[0],
+                             static_cast<unsigned int>(frame_size), NULL, 0));
+  EXPECT_LE(state.arrived, frame_size / 2);
+
+  // The same frame decodes once all of it arrives.
+  state.fail_after = frame_size;
+  EXPECT_EQ(VPX_CODEC_OK,
+            vpx_codec_decode(&dec, &buffer[0],
+                             static_cast<unsigned int>(frame_size), NULL, 0));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&enc));
+}
+
+VP9_INSTANTIATE_TEST_CASE(InputWaitTest, ::testing::Values(1, 2),
+                          ::testing::Range(0, 2));
+}  // namespace
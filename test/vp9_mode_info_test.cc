@@ -0,0 +1,235 @@
+/*
+ *  Copyright (c) 2017 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <vector>
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/i420_video_source.h"
+#include "test/util.h"
+#include "vpx/vp8cx.h"
+#include "vpx/vp8dx.h"
+
+namespace {
+
+const int kWidth = 448;
+const int kHeight = 256;
+const int kFrames = 10;
+
+// Re-encodes decoded frames at a lower rate, the way a transcoder would.
+class Transcoder {
+ public:
+  Transcoder(::libvpx_test::TestMode mode, bool use_hints)
+      : mode_(mode), use_hints_(use_hints), psnr_sum_(0), frames_(0),
+        mismatched_blocks_(0), hinted_frames_(0) {}
+
+  ~Transcoder() {
+    vpx_codec_destroy(&enc_);
+    vpx_codec_destroy(&dec_);
+  }
+
+  void Init() {
+    vpx_codec_enc_cfg_t cfg;
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_enc_config_default(&vpx_codec_vp9_cx_algo, &cfg, 0));
+    cfg.g_w = kWidth;
+    cfg.g_h = kHeight;
+    cfg.g_lag_in_frames = 0;
+    cfg.rc_end_usage = VPX_CBR;
+    cfg.rc_target_bitrate = 200;
+    ASSERT_EQ(VPX_CODEC_OK, vpx_codec_enc_init(&enc_, &vpx_codec_vp9_cx_algo,
+                                               &cfg, VPX_CODEC_USE_PSNR));
+    ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(&enc_, VP8E_SET_CPUUSED,
+                                              mode_ == ::libvpx_test::kRealTime
+                                                  ? 6
+                                                  : 2));
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_dec_init(&dec_, &vpx_codec_vp9_dx_algo, NULL, 0));
+  }
+
+  void Encode(const vpx_image_t *img, vpx_mode_info_t *info, int frame) {
+    if (use_hints_) {
+      ASSERT_EQ(VPX_CODEC_OK,
+                vpx_codec_control(&enc_, VP9E_SET_MODE_INFO_HINTS, info));
+    }
+    const unsigned long deadline = mode_ == ::libvpx_test::kRealTime
+                                       ? VPX_DL_REALTIME
+                                       : VPX_DL_GOOD_QUALITY;
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_encode(&enc_, img, frame, 1, 0, deadline));
+
+    vpx_codec_iter_t iter = NULL;
+    const vpx_codec_cx_pkt_t *pkt;
+    while ((pkt = vpx_codec_get_cx_data(&enc_, &iter)) != NULL) {
+      if (pkt->kind == VPX_CODEC_PSNR_PKT) {
+        psnr_sum_ += pkt->data.psnr.psnr[0];
+        ++frames_;
+      } else if (pkt->kind == VPX_CODEC_CX_FRAME_PKT) {
+        ASSERT_EQ(VPX_CODEC_OK,
+                  vpx_codec_decode(
+                      &dec_, static_cast<uint8_t *>(pkt->data.frame.buf),
+                      static_cast<unsigned int>(pkt->data.frame.sz), NULL, 0));
+        if (use_hints_ && (pkt->data.frame.flags & VPX_FRAME_IS_KEY) == 0)
+          CheckBlockSizes(info);
+      }
+    }
+  }
+
+  // In real-time mode the blocks are coded with the block sizes of the hints,
+  // with blocks smaller than 8x8 grown to 8x8.
+  void CheckBlockSizes(const vpx_mode_info_t *hints) {
+    vpx_mode_info_t info;
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(&dec_, VP9D_GET_MODE_INFO, &info));
+    ASSERT_EQ(hints->mi_rows, info.mi_rows);
+    ASSERT_EQ(hints->mi_cols, info.mi_cols);
+    ++hinted_frames_;
+    if (mode_ != ::libvpx_test::kRealTime) return;
+    for (int i = 0; i < info.mi_rows * info.mi_cols; ++i) {
+      const vpx_block_mode_info_t &hint = hints->blocks[i];
+      const vpx_block_mode_info_t &block = info.blocks[i];
+      if (block.width != std::max<int>(hint.width, 8) ||
+          block.height != std::max<int>(hint.height, 8))
+        ++mismatched_blocks_;
+    }
+  }
+
+  double AveragePsnr() const { return frames_ ? psnr_sum_ / frames_ : 0; }
+
+  ::libvpx_test::TestMode mode_;
+  bool use_hints_;
+  vpx_codec_ctx_t enc_;
+  vpx_codec_ctx_t dec_;
+  double psnr_sum_;
+  int frames_;
+  int mismatched_blocks_;
+  int hinted_frames_;
+};
+
+class ModeInfoHintsTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWithParam<libvpx_test::TestMode> {
+ protected:
+  ModeInfoHintsTest()
+      : EncoderTest(GET_PARAM(0)), frame_(0), hinted_(GET_PARAM(1), true),
+        unhinted_(GET_PARAM(1), false) {
+    vpx_codec_dec_cfg_t cfg = vpx_codec_dec_cfg_t();
+    decoder_ = codec_->CreateDecoder(cfg, 0);
+  }
+
+  virtual ~ModeInfoHintsTest() { delete decoder_; }
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(libvpx_test::kRealTime);
+    cfg_.g_lag_in_frames = 0;
+    ASSERT_NO_FATAL_FAILURE(hinted_.Init());
+    ASSERT_NO_FATAL_FAILURE(unhinted_.Init());
+  }
+
+  virtual void PreEncodeFrameHook(libvpx_test::VideoSource *video,
+                                  libvpx_test::Encoder *encoder) {
+    if (video->frame() == 0) encoder->Control(VP8E_SET_CPUUSED, 6);
+  }
+
+  virtual void FramePktHook(const vpx_codec_cx_pkt_t *pkt) {
+    const vpx_codec_err_t res = decoder_->DecodeFrame(
+        reinterpret_cast<uint8_t *>(pkt->data.frame.buf), pkt->data.frame.sz);
+    ASSERT_EQ(VPX_CODEC_OK, res) << decoder_->DecodeError();
+    const vpx_image_t *const img = decoder_->GetDxData().Next();
+    ASSERT_TRUE(img != NULL);
+
+    vpx_mode_info_t info;
+    ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(decoder_->GetDecoder(),
+                                              VP9D_GET_MODE_INFO, &info));
+    EXPECT_EQ((kWidth + 7) / 8, info.mi_cols);
+    EXPECT_EQ((kHeight + 7) / 8, info.mi_rows);
+    for (int i = 0; i < info.mi_rows * info.mi_cols; ++i) {
+      const vpx_block_mode_info_t &block = info.blocks[i];
+      ASSERT_GE(block.ref_frame[0], 0);
+      ASSERT_LE(block.ref_frame[0], 3);
+      if (frame_ == 0) {
+        ASSERT_EQ(0, block.ref_frame[0]);
+      }
+    }
+
+    ASSERT_NO_FATAL_FAILURE(hinted_.Encode(img, &info, frame_));
+    ASSERT_NO_FATAL_FAILURE(unhinted_.Encode(img, &info, frame_));
+    ++frame_;
+  }
+
+  int frame_;
+  Transcoder hinted_;
+  Transcoder unhinted_;
+  ::libvpx_test::Decoder *decoder_;
+};
+
+// Transcodes a stream with and without the mode info of the decoded frames.
+// The hints are used on every inter frame and cost little quality.
+TEST_P(ModeInfoHintsTest, TranscodeWithHints) {
+  cfg_.rc_target_bitrate = 1000;
+  libvpx_test::I420VideoSource video("hantro_collage_w352h288.yuv", kWidth,
+                                     kHeight, 30, 1, 0, kFrames);
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  EXPECT_EQ(kFrames, frame_);
+  EXPECT_EQ(kFrames - 1, hinted_.hinted_frames_);
+  EXPECT_EQ(0, hinted_.mismatched_blocks_);
+  EXPECT_EQ(kFrames, hinted_.frames_);
+  EXPECT_GT(hinted_.AveragePsnr(), unhinted_.AveragePsnr() - 1.0);
+}
+
+TEST(ModeInfoAPI, InvalidParams) {
+  vpx_codec_ctx_t enc, dec;
+  vpx_codec_enc_cfg_t cfg;
+  vpx_mode_info_t info;
+  std::vector<vpx_block_mode_info_t> blocks(4);
+
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_dec_init(&dec, &vpx_codec_vp9_dx_algo, NULL, 0));
+  EXPECT_EQ(VPX_CODEC_ERROR,
+            vpx_codec_control(&dec, VP9D_GET_MODE_INFO, &info));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_enc_config_default(&vpx_codec_vp9_cx_algo, &cfg, 0));
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_enc_init(&enc, &vpx_codec_vp9_cx_algo, &cfg, 0));
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    blocks[i].width = 16;
+    blocks[i].height = 8;
+    blocks[i].ref_frame[0] = 1;
+    blocks[i].ref_frame[1] = -1;
+    blocks[i].skip = 0;
+  }
+  info.mi_rows = 2;
+  info.mi_cols = 2;
+  info.blocks = &blocks[0];
+  EXPECT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&enc, VP9E_SET_MODE_INFO_HINTS, &info));
+  blocks[3].height = 12;
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&enc, VP9E_SET_MODE_INFO_HINTS, &info));
+  blocks[3].height = 64;
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&enc, VP9E_SET_MODE_INFO_HINTS, &info));
+  info.mi_rows = 0;
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&enc, VP9E_SET_MODE_INFO_HINTS, &info));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_control(&enc, VP9E_SET_MODE_INFO_HINTS,
+                                            static_cast<vpx_mode_info_t *>(
+                                                NULL)));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&enc));
+}
+
+VP9_INSTANTIATE_TEST_CASE(ModeInfoHintsTest,
+                          ::testing::Values(::libvpx_test::kRealTime,
+                                            ::libvpx_test::kOnePassGood));
+}  // namespace
@@ -0,0 +1,142 @@
+/*
+ *  Copyright (c) 2017 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <cstring>
+#include <vector>
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/i420_video_source.h"
+#include "test/util.h"
+#include "vpx/vp8cx.h"
+#include "vpx/vp8dx.h"
+#include "vpx/vpx_decoder.h"
+
+namespace {
+
+const int kWidth = 704;
+const int kHeight = 288;
+
+// Copies the rows of each slice as they are posted, so that they can be
+// compared with the frame once it is output.
+struct SliceState {
+  std::vector<uint8_t> planes[3];
+  unsigned int rows_done;
+  int num_slices;
+  bool in_order;
+};
+
+void PutSlice(void *user_priv, const vpx_image_t *img,
+              const vpx_image_rect_t *valid, const vpx_image_rect_t *update) {
+  SliceState *const state = static_cast<SliceState *>(user_priv);
+  state->in_order &= valid->x == 0 && valid->y == 0 && valid->w == img->d_w &&
+                     update->y == state->rows_done &&
+                     update->y + update->h == valid->h && update->h > 0;
+  for (int plane = 0; plane < 3; ++plane) {
+    const int shift = plane ? img->y_chroma_shift : 0;
+    const int stride = img->stride[plane];
+    const unsigned int y_start = (update->y + (1 << shift) - 1) >> shift;
+    const unsigned int y_end =
+        (update->y + update->h + (1 << shift) - 1) >> shift;
+    std::vector<uint8_t> &copy = state->planes[plane];
+    if (copy.size() < y_end * stride) copy.resize(y_end * stride);
+    memcpy(&copy[y_start * stride], img->planes[plane] + y_start * stride,
+           (y_end - y_start) * stride);
+  }
+  state->rows_done = valid->h;
+  ++state->num_slices;
+}
+
+class PutSliceTest : public ::libvpx_test::EncoderTest,
+                     public ::libvpx_test::CodecTestWith2Params<int, int> {
+ protected:
+  PutSliceTest()
+      : EncoderTest(GET_PARAM(0)), threads_(GET_PARAM(1)),
+        loop_filter_(GET_PARAM(2) != 0), frame_(0), sliced_frames_(0) {
+    vpx_codec_dec_cfg_t cfg = vpx_codec_dec_cfg_t();
+    cfg.threads = threads_;
+    decoder_ = codec_->CreateDecoder(cfg, 0);
+    decoder_->Control(VP9_SET_SKIP_LOOP_FILTER, !loop_filter_);
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_register_put_slice_cb(decoder_->GetDecoder(), PutSlice,
+                                              &state_));
+  }
+
+  virtual ~PutSliceTest() { delete decoder_; }
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(libvpx_test::kRealTime);
+    cfg_.g_lag_in_frames = 0;
+  }
+
+  virtual void PreEncodeFrameHook(libvpx_test::VideoSource *video,
+                                  libvpx_test::Encoder *encoder) {
+    if (video->frame() == 0) {
+      encoder->Control(VP8E_SET_CPUUSED, 6);
+      encoder->Control(VP9E_SET_TILE_COLUMNS, 1);
+    }
+  }
+
+  virtual void FramePktHook(const vpx_codec_cx_pkt_t *pkt) {
+    state_.rows_done = 0;
+    state_.num_slices = 0;
+    state_.in_order = true;
+    const vpx_codec_err_t res = decoder_->DecodeFrame(
+        reinterpret_cast<uint8_t *>(pkt->data.frame.buf), pkt->data.frame.sz);
+    ASSERT_EQ(VPX_CODEC_OK, res) << decoder_->DecodeError();
+    const vpx_image_t *const img = decoder_->GetDxData().Next();
+    ASSERT_TRUE(img != NULL);
+
+    // The slices cover the frame from the top, and no row changes after it
+    // was posted.
+    EXPECT_TRUE(state_.in_order) << "frame " << frame_;
+    EXPECT_EQ(img->d_h, state_.rows_done) << "frame " << frame_;
+    for (int plane = 0; plane < 3; ++plane) {
+      const int shift = plane ? img->y_chroma_shift : 0;
+      const int width = (img->d_w + (1 << shift) - 1) >> shift;
+      const int height = (img->d_h + (1 << shift) - 1) >> shift;
+      const int stride = img->stride[plane];
+      for (int y = 0; y < height; ++y) {
+        ASSERT_EQ(0, memcmp(&state_.planes[plane][y * stride],
+                            img->planes[plane] + y * stride, width))
+            << "frame " << frame_ << " plane " << plane << " row " << y;
+      }
+    }
+    if (state_.num_slices > 1) ++sliced_frames_;
+    ++frame_;
+  }
+
+  int threads_;
+  bool loop_filter_;
+  int frame_;
+  int sliced_frames_;
+  SliceState state_;
+  ::libvpx_test::Decoder *decoder_;
+};
+
+// Decodes a stream with 2 tile columns. Rows are posted as they are
+// reconstructed when tiles are decoded on one thread, and the whole frame at
+// once when tile columns are decoded on several threads.
+TEST_P(PutSliceTest, SlicesMatchFrame) {
+  cfg_.rc_target_bitrate = 500;
+  libvpx_test::I420VideoSource video("hantro_collage_w352h288.yuv", kWidth,
+                                     kHeight, 30, 1, 0, 10);
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  EXPECT_EQ(10, frame_);
+  if (threads_ == 1)
+    EXPECT_EQ(frame_, sliced_frames_);
+  else
+    EXPECT_EQ(0, sliced_frames_);
+}
+
+VP9_INSTANTIATE_TEST_CASE(PutSliceTest, ::testing::Values(1, 2),
+                          ::testing::Range(0, 2));
+}  // namespace
@@ -0,0 +1,127 @@
+/*
+ *  Copyright (c) 2017 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <cstring>
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/i420_video_source.h"
+#include "test/md5_helper.h"
+#include "test/util.h"
+#include "vpx/vp8cx.h"
+#include "vpx/vp8dx.h"
+
+namespace {
+
+const int kNoUpdate =
+    VP8_EFLAG_NO_UPD_LAST | VP8_EFLAG_NO_UPD_GF | VP8_EFLAG_NO_UPD_ARF;
+
+enum SkipMode { kDropNonReference, kKeyFramesOnly };
+
+class SkipFramesTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWith2Params<SkipMode, int> {
+ protected:
+  SkipFramesTest()
+      : EncoderTest(GET_PARAM(0)), mode_(GET_PARAM(1)),
+        error_resilient_(GET_PARAM(2)), frame_(0), skipped_(0) {
+    vpx_codec_dec_cfg_t cfg = vpx_codec_dec_cfg_t();
+    full_dec_ = codec_->CreateDecoder(cfg, 0);
+    skip_dec_ = codec_->CreateDecoder(cfg, 0);
+    if (mode_ == kDropNonReference)
+      skip_dec_->Control(VP9_SET_DROP_NON_REFERENCE, 1);
+    else
+      skip_dec_->Control(VP9_SET_KEY_FRAMES_ONLY, 1);
+  }
+
+  virtual ~SkipFramesTest() {
+    delete full_dec_;
+    delete skip_dec_;
+  }
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(libvpx_test::kRealTime);
+    cfg_.g_lag_in_frames = 0;
+    cfg_.g_error_resilient = error_resilient_;
+    cfg_.kf_max_dist = 12;
+  }
+
+  virtual void PreEncodeFrameHook(libvpx_test::VideoSource *video,
+                                  libvpx_test::Encoder *encoder) {
+    if (video->frame() == 0) encoder->Control(VP8E_SET_CPUUSED, 6);
+    // Every other frame updates no reference buffer.
+    frame_flags_ = (video->frame() & 1) ? kNoUpdate : 0;
+  }
+
+  const vpx_image_t *Decode(::libvpx_test::Decoder *dec,
+                            const vpx_codec_cx_pkt_t *pkt) {
+    const vpx_codec_err_t res = dec->DecodeFrame(
+        reinterpret_cast<uint8_t *>(pkt->data.frame.buf), pkt->data.frame.sz);
+    if (res != VPX_CODEC_OK) {
+      abort_ = true;
+      EXPECT_EQ(VPX_CODEC_OK, res) << dec->DecodeError();
+      return NULL;
+    }
+    return dec->GetDxData().Next();
+  }
+
+  virtual void FramePktHook(const vpx_codec_cx_pkt_t *pkt) {
+    const bool is_key = (pkt->data.frame.flags & VPX_FRAME_IS_KEY) != 0;
+    const vpx_image_t *const full = Decode(full_dec_, pkt);
+    const vpx_image_t *const skip = Decode(skip_dec_, pkt);
+    if (abort_) return;
+
+    // Frames of an error resilient stream don't carry their entropy contexts
+    // over, so those that update no reference can be dropped.
+    bool skipped;
+    if (mode_ == kKeyFramesOnly)
+      skipped = !is_key;
+    else
+      skipped = error_resilient_ && (frame_ & 1) && !is_key;
+    ASSERT_TRUE(full != NULL);
+    EXPECT_EQ(skipped, skip == NULL) << "frame " << frame_;
+
+    if (skip != NULL) {
+      ::libvpx_test::MD5 full_md5, skip_md5;
+      full_md5.Add(full);
+      skip_md5.Add(skip);
+      EXPECT_STREQ(full_md5.Get(), skip_md5.Get()) << "frame " << frame_;
+    } else {
+      ++skipped_;
+    }
+    ++frame_;
+  }
+
+  SkipMode mode_;
+  int error_resilient_;
+  int frame_;
+  int skipped_;
+  ::libvpx_test::Decoder *full_dec_;
+  ::libvpx_test::Decoder *skip_dec_;
+};
+
+// Frames that are skipped are not output, and every frame that is output
+// matches a full decode.
+TEST_P(SkipFramesTest, MatchesFullDecode) {
+  cfg_.rc_target_bitrate = 300;
+  libvpx_test::I420VideoSource video("hantro_collage_w352h288.yuv", 352, 288,
+                                     30, 1, 0, 30);
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  if (mode_ == kDropNonReference && !error_resilient_)
+    EXPECT_EQ(0, skipped_);
+  else
+    EXPECT_GT(skipped_, 0);
+}
+
+VP9_INSTANTIATE_TEST_CASE(SkipFramesTest,
+                          ::testing::Values(kDropNonReference, kKeyFramesOnly),
+                          ::testing::Range(0, 2));
+}  // namespace
@@ -0,0 +1,194 @@
+/*
+ *  Copyright (c) 2017 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <cstdlib>
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/i420_video_source.h"
+#include "test/util.h"
+#include "vpx/vp8cx.h"
+#include "vpx/vpx_encoder.h"
+
+namespace {
+
+const int kWidth = 352;
+const int kHeight = 288;
+
+class SpeedTargetTest : public ::testing::Test {
+ protected:
+  SpeedTargetTest()
+      : video_("hantro_collage_w352h288.yuv", kWidth, kHeight, 30, 1, 0, 100),
+        frame_(0), speed_(-1), next_speed_(-1), late_blocks_(0) {}
+
+  virtual ~SpeedTargetTest() { vpx_codec_destroy(&enc_); }
+
+  void Init(int cpu_used) {
+    vpx_codec_enc_cfg_t cfg;
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_enc_config_default(&vpx_codec_vp9_cx_algo, &cfg, 0));
+    cfg.g_w = kWidth;
+    cfg.g_h = kHeight;
+    cfg.g_lag_in_frames = 0;
+    cfg.rc_end_usage = VPX_CBR;
+    cfg.rc_target_bitrate = 500;
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_enc_init(&enc_, &vpx_codec_vp9_cx_algo, &cfg, 0));
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(&enc_, VP8E_SET_CPUUSED, cpu_used));
+    ASSERT_NO_FATAL_FAILURE(video_.Begin());
+  }
+
+  void SetTarget(unsigned int frame_time, unsigned int percentile) {
+    vpx_speed_target_t target;
+    target.frame_time = frame_time;
+    target.percentile = percentile;
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(&enc_, VP9E_SET_SPEED_TARGET, &target));
+  }
+
+  // Encodes a frame and checks that it is followed by a speed packet.
+  void EncodeFrame() {
+    ASSERT_TRUE(video_.img() != NULL);
+    ASSERT_EQ(VPX_CODEC_OK, vpx_codec_encode(&enc_, video_.img(), frame_, 1,
+                                             0, VPX_DL_REALTIME));
+    video_.Next();
+    ++frame_;
+
+    vpx_codec_iter_t iter = NULL;
+    const vpx_codec_cx_pkt_t *pkt;
+    int speed_pkts = 0;
+    while ((pkt = vpx_codec_get_cx_data(&enc_, &iter)) != NULL) {
+      if (pkt->kind != VPX_CODEC_SPEED_PKT) continue;
+      if (next_speed_ >= 0) {
+        EXPECT_EQ(next_speed_, pkt->data.speed.speed);
+      }
+      speed_ = pkt->data.speed.speed;
+      next_speed_ = pkt->data.speed.next_speed;
+      late_blocks_ += pkt->data.speed.late_blocks;
+      EXPECT_LE(abs(next_speed_ - speed_), 1);
+      ++speed_pkts;
+    }
+    EXPECT_EQ(1, speed_pkts) << "frame " << frame_;
+  }
+
+  libvpx_test::I420VideoSource video_;
+  vpx_codec_ctx_t enc_;
+  int frame_;
+  int speed_;
+  int next_speed_;
+  unsigned int late_blocks_;
+};
+
+// Frames that miss the target raise the speed up to 8, and a window of
+// frames that meets it lowers the speed again.
+TEST_F(SpeedTargetTest, NonRdSpeeds) {
+  ASSERT_NO_FATAL_FAILURE(Init(5));
+  ASSERT_NO_FATAL_FAILURE(SetTarget(1, 100));
+  for (int i = 0; i < 5; ++i) ASSERT_NO_FATAL_FAILURE(EncodeFrame());
+  EXPECT_EQ(8, speed_);
+  EXPECT_EQ(8, next_speed_);
+  EXPECT_GT(late_blocks_, 0u);
+
+  // Changing the target keeps the speed.
+  ASSERT_NO_FATAL_FAILURE(SetTarget(1000000, 90));
+  late_blocks_ = 0;
+  for (int i = 0; i < 29; ++i) ASSERT_NO_FATAL_FAILURE(EncodeFrame());
+  EXPECT_EQ(0u, late_blocks_);
+  EXPECT_EQ(8, next_speed_);
+  ASSERT_NO_FATAL_FAILURE(EncodeFrame());
+  EXPECT_EQ(7, next_speed_);
+}
+
+// With a 90th percentile target, the speed is raised on the 4th late frame.
+TEST_F(SpeedTargetTest, Percentile) {
+  ASSERT_NO_FATAL_FAILURE(Init(6));
+  ASSERT_NO_FATAL_FAILURE(SetTarget(1, 90));
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_NO_FATAL_FAILURE(EncodeFrame());
+    EXPECT_EQ(6, next_speed_);
+  }
+  ASSERT_NO_FATAL_FAILURE(EncodeFrame());
+  EXPECT_EQ(7, next_speed_);
+}
+
+// Speeds below 5 stay on the rd search path.
+TEST_F(SpeedTargetTest, RdSpeeds) {
+  ASSERT_NO_FATAL_FAILURE(Init(3));
+  ASSERT_NO_FATAL_FAILURE(SetTarget(1, 100));
+  for (int i = 0; i < 3; ++i) ASSERT_NO_FATAL_FAILURE(EncodeFrame());
+  EXPECT_EQ(4, speed_);
+  EXPECT_EQ(4, next_speed_);
+  EXPECT_GT(late_blocks_, 0u);
+}
+
+TEST_F(SpeedTargetTest, InvalidParams) {
+  ASSERT_NO_FATAL_FAILURE(Init(5));
+  vpx_speed_target_t target;
+  target.frame_time = 1000;
+  target.percentile = 0;
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&enc_, VP9E_SET_SPEED_TARGET, &target));
+  target.percentile = 101;
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&enc_, VP9E_SET_SPEED_TARGET, &target));
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&enc_, VP9E_SET_SPEED_TARGET,
+                              static_cast<vpx_speed_target_t *>(NULL)));
+
+  // No speed packets without a target.
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_encode(&enc_, video_.img(), 0, 1, 0,
+                                           VPX_DL_REALTIME));
+  vpx_codec_iter_t iter = NULL;
+  const vpx_codec_cx_pkt_t *pkt;
+  while ((pkt = vpx_codec_get_cx_data(&enc_, &iter)) != NULL)
+    EXPECT_NE(VPX_CODEC_SPEED_PKT, pkt->kind);
+}
+
+// Superblocks coded behind the time budget use faster searches. The encoder
+// and decoder stay in sync on every search path.
+class SpeedTargetEncodeTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWith2Params<int, int> {
+ protected:
+  SpeedTargetEncodeTest() : EncoderTest(GET_PARAM(0)) {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(libvpx_test::kRealTime);
+    cfg_.g_lag_in_frames = 0;
+    cfg_.g_threads = GET_PARAM(2);
+    cfg_.rc_end_usage = VPX_CBR;
+    cfg_.rc_target_bitrate = 500;
+  }
+
+  virtual void PreEncodeFrameHook(libvpx_test::VideoSource *video,
+                                  libvpx_test::Encoder *encoder) {
+    if (video->frame() == 0) {
+      vpx_speed_target_t target;
+      target.frame_time = 1;
+      target.percentile = 100;
+      encoder->Control(VP8E_SET_CPUUSED, GET_PARAM(1));
+      encoder->Control(VP9E_SET_TILE_COLUMNS, 1);
+      encoder->Control(VP9E_SET_ROW_MT, 1);
+      encoder->Control(VP9E_SET_SPEED_TARGET, &target);
+    }
+  }
+};
+
+TEST_P(SpeedTargetEncodeTest, EncodeDecodeMatch) {
+  libvpx_test::I420VideoSource video("hantro_collage_w352h288.yuv", kWidth,
+                                     kHeight, 30, 1, 0, 10);
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+}
+
+VP9_INSTANTIATE_TEST_CASE(SpeedTargetEncodeTest, ::testing::Values(3, 5, 7),
+                          ::testing::Values(1, 2));
+}  // namespace
@@ -0,0 +1,146 @@
+/*
+ *  Copyright (c) 2017 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <cstring>
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/i420_video_source.h"
+#include "test/util.h"
+#include "vpx/vp8dx.h"
+
+namespace {
+
+const int kWidth = 704;
+const int kHeight = 144;
+// With 2 tile columns the 11 superblock columns are split after the 5th.
+const int kTileSplit = 5 * 64;
+// Pixels next to the region edge that the loop filter may change.
+const int kEdgeMargin = 16;
+
+class TileRegionTest : public ::libvpx_test::EncoderTest,
+                       public ::libvpx_test::CodecTestWithParam<int> {
+ protected:
+  TileRegionTest()
+      : EncoderTest(GET_PARAM(0)), region_col_(GET_PARAM(1)),
+        frame_(0), frames_checked_(0) {
+    vpx_codec_dec_cfg_t cfg = vpx_codec_dec_cfg_t();
+    cfg.w = kWidth;
+    cfg.h = kHeight;
+    cfg.threads = 1;
+    full_dec_ = codec_->CreateDecoder(cfg, 0);
+    region_dec_ = codec_->CreateDecoder(cfg, 0);
+    vpx_tile_region_t region = { region_col_, region_col_, -1 };
+    region_dec_->Control(VP9_SET_DECODE_TILE_REGION, &region);
+  }
+
+  virtual ~TileRegionTest() {
+    delete full_dec_;
+    delete region_dec_;
+  }
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(libvpx_test::kTwoPassGood);
+  }
+
+  virtual void PreEncodeFrameHook(libvpx_test::VideoSource *video,
+                                  libvpx_test::Encoder *encoder) {
+    if (video->frame() == 0) {
+      encoder->Control(VP9E_SET_TILE_COLUMNS, 1);
+    }
+  }
+
+  const vpx_image_t *Decode(::libvpx_test::Decoder *dec,
+                            const vpx_codec_cx_pkt_t *pkt) {
+    const vpx_codec_err_t res = dec->DecodeFrame(
+        reinterpret_cast<uint8_t *>(pkt->data.frame.buf), pkt->data.frame.sz);
+    if (res != VPX_CODEC_OK) {
+      abort_ = true;
+      EXPECT_EQ(VPX_CODEC_OK, res) << dec->DecodeError();
+      return NULL;
+    }
+    return dec->GetDxData().Next();
+  }
+
+  // Compares the two images inside the luma rectangle, and the chroma pixels
+  // it covers.
+  void CompareRect(const vpx_image_t *full, const vpx_image_t *region,
+                   const vpx_image_rect_t &rect) {
+    for (int plane = 0; plane < 3; ++plane) {
+      const int shift_x = plane ? full->x_chroma_shift : 0;
+      const int shift_y = plane ? full->y_chroma_shift : 0;
+      const int x0 = (rect.x + (1 << shift_x) - 1) >> shift_x;
+      const int width = ((rect.x + rect.w) >> shift_x) - x0;
+      const int height = (rect.h >> shift_y);
+      for (int y = 0; y < height; ++y) {
+        const uint8_t *const a =
+            full->planes[plane] + y * full->stride[plane] + x0;
+        const uint8_t *const b =
+            region->planes[plane] + y * region->stride[plane] + x0;
+        ASSERT_EQ(0, memcmp(a, b, width))
+            << "frame " << frame_ << " plane " << plane << " row " << y;
+      }
+    }
+  }
+
+  virtual void FramePktHook(const vpx_codec_cx_pkt_t *pkt) {
+    const vpx_image_t *const full = Decode(full_dec_, pkt);
+    const vpx_image_t *const region = Decode(region_dec_, pkt);
+    if (full == NULL || region == NULL) return;
+
+    vpx_image_rect_t rect;
+    ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(region_dec_->GetDecoder(),
+                                              VP9D_GET_VALID_REGION, &rect));
+    // The valid area never reaches the pixels the loop filter may change
+    // across the region edge.
+    const int x_start = region_col_ == 0 ? 0 : kTileSplit + kEdgeMargin;
+    const int x_end = region_col_ == 0 ? kTileSplit - kEdgeMargin : kWidth;
+    if (rect.w > 0) {
+      EXPECT_LE(x_start, static_cast<int>(rect.x));
+      EXPECT_GE(x_end, static_cast<int>(rect.x + rect.w));
+      EXPECT_GE(kHeight, static_cast<int>(rect.h));
+      ASSERT_NO_FATAL_FAILURE(CompareRect(full, region, rect));
+      ++frames_checked_;
+    }
+    if (pkt->data.frame.flags & VPX_FRAME_IS_KEY) {
+      EXPECT_EQ(x_start, static_cast<int>(rect.x));
+      EXPECT_EQ(x_end, static_cast<int>(rect.x + rect.w));
+      EXPECT_EQ(kHeight, static_cast<int>(rect.h));
+    }
+    ++frame_;
+  }
+
+  int region_col_;
+  int frame_;
+  int frames_checked_;
+  ::libvpx_test::Decoder *full_dec_;
+  ::libvpx_test::Decoder *region_dec_;
+};
+
+// Encodes with 2 tile columns and decodes only one of them. Every frame must
+// match a full decode inside the valid area reported by the decoder, which
+// covers the whole region on keyframes.
+TEST_P(TileRegionTest, RegionMatchesFullDecode) {
+  const vpx_rational timebase = { 33333333, 1000000000 };
+  cfg_.g_timebase = timebase;
+  cfg_.rc_target_bitrate = 500;
+  cfg_.g_lag_in_frames = 25;
+  cfg_.rc_end_usage = VPX_VBR;
+
+  libvpx_test::I420VideoSource video("hantro_collage_w352h288.yuv", kWidth,
+                                     kHeight, timebase.den, timebase.num, 0,
+                                     20);
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  EXPECT_GT(frames_checked_, 1);
+}
+
+VP9_INSTANTIATE_TEST_CASE(TileRegionTest, ::testing::Range(0, 2));
+}  // namespace
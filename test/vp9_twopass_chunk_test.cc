@@ -0,0 +1,153 @@
+/*
+ *  Copyright (c) 2017 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string>
+#include <vector>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+
+#include "test/i420_video_source.h"
+#include "vpx/vp8cx.h"
+#include "vpx/vpx_encoder.h"
+
+namespace {
+
+const char kInput[] = "hantro_collage_w352h288.yuv";
+const int kWidth = 352;
+const int kHeight = 288;
+const int kFrames = 20;
+const int kChunkFrames = 10;
+
+class TwoPassChunkTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_enc_config_default(&vpx_codec_vp9_cx_algo, &cfg_, 0));
+    cfg_.g_w = kWidth;
+    cfg_.g_h = kHeight;
+    cfg_.g_timebase.num = 1;
+    cfg_.g_timebase.den = 30;
+    cfg_.g_lag_in_frames = 10;
+    cfg_.rc_end_usage = VPX_VBR;
+    cfg_.rc_target_bitrate = 300;
+  }
+
+  void InitEncoder(vpx_codec_ctx_t *enc) {
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_enc_init(enc, &vpx_codec_vp9_cx_algo, &cfg_, 0));
+    ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(enc, VP8E_SET_CPUUSED, 4));
+  }
+
+  // Encodes frames [first, first + count) of the input and returns the
+  // packets of the given kind, one string per packet.
+  std::vector<std::string> Encode(vpx_codec_ctx_t *enc, int first, int count,
+                                  vpx_codec_cx_pkt_kind kind) {
+    std::vector<std::string> pkts;
+    libvpx_test::I420VideoSource video(kInput, kWidth, kHeight, 30, 1, first,
+                                       first + count);
+    video.Begin();
+    for (bool again = true; again;) {
+      again = video.img() != NULL;
+      EXPECT_EQ(VPX_CODEC_OK,
+                vpx_codec_encode(enc, video.img(), video.pts() - first, 1, 0,
+                                 VPX_DL_GOOD_QUALITY));
+      vpx_codec_iter_t iter = NULL;
+      const vpx_codec_cx_pkt_t *pkt;
+      while ((pkt = vpx_codec_get_cx_data(enc, &iter)) != NULL) {
+        again = true;
+        if (pkt->kind != kind) continue;
+        if (kind == VPX_CODEC_STATS_PKT) {
+          pkts.push_back(std::string(
+              static_cast<const char *>(pkt->data.twopass_stats.buf),
+              pkt->data.twopass_stats.sz));
+        } else {
+          if (pkts.empty()) {
+            EXPECT_TRUE(pkt->data.frame.flags & VPX_FRAME_IS_KEY);
+          }
+          pkts.push_back(
+              std::string(static_cast<const char *>(pkt->data.frame.buf),
+                          pkt->data.frame.sz));
+        }
+      }
+      if (video.img() != NULL) video.Next();
+    }
+    return pkts;
+  }
+
+  // Runs the first pass over each chunk and stitches the stats: all the per
+  // frame packets in order, followed by the end of stream packet of each
+  // chunk.
+  std::string StitchedFirstPass() {
+    std::string frames;
+    std::string eos;
+    cfg_.g_pass = VPX_RC_FIRST_PASS;
+    for (int first = 0; first < kFrames; first += kChunkFrames) {
+      vpx_codec_ctx_t enc;
+      InitEncoder(&enc);
+      const std::vector<std::string> stats =
+          Encode(&enc, first, kChunkFrames, VPX_CODEC_STATS_PKT);
+      EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&enc));
+      EXPECT_EQ(static_cast<size_t>(kChunkFrames + 1), stats.size());
+      for (size_t i = 0; i + 1 < stats.size(); ++i) frames += stats[i];
+      eos += stats.back();
+    }
+    return frames + eos;
+  }
+
+  // Returns the number of bytes produced by the second pass of the given
+  // chunk, or of the whole stream if chunk is -1.
+  size_t SecondPass(const std::string &stats, int chunk) {
+    const int first = chunk < 0 ? 0 : chunk * kChunkFrames;
+    const int count = chunk < 0 ? kFrames : kChunkFrames;
+    vpx_codec_ctx_t enc;
+    size_t bytes = 0;
+    cfg_.g_pass = VPX_RC_LAST_PASS;
+    cfg_.rc_twopass_stats_in.buf = const_cast<char *>(stats.data());
+    cfg_.rc_twopass_stats_in.sz = stats.size();
+    InitEncoder(&enc);
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(&enc, VP9E_SET_TWOPASS_CHUNK, chunk));
+    const std::vector<std::string> frames =
+        Encode(&enc, first, count, VPX_CODEC_CX_FRAME_PKT);
+    EXPECT_EQ(static_cast<size_t>(count), frames.size());
+    EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+              vpx_codec_control(&enc, VP9E_SET_TWOPASS_CHUNK, -1));
+    EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&enc));
+    for (size_t i = 0; i < frames.size(); ++i) bytes += frames[i].size();
+    return bytes;
+  }
+
+  vpx_codec_enc_cfg_t cfg_;
+};
+
+TEST_F(TwoPassChunkTest, ChunksShareStreamBudget) {
+  const std::string stats = StitchedFirstPass();
+  const size_t stream_bytes = SecondPass(stats, -1);
+  const size_t chunk_bytes = SecondPass(stats, 0) + SecondPass(stats, 1);
+  ASSERT_GT(stream_bytes, 0u);
+  EXPECT_NEAR(1.0, static_cast<double>(chunk_bytes) / stream_bytes, 0.25);
+}
+
+TEST_F(TwoPassChunkTest, RejectsChunkOutOfRange) {
+  const std::string stats = StitchedFirstPass();
+  vpx_codec_ctx_t enc;
+  cfg_.g_pass = VPX_RC_LAST_PASS;
+  cfg_.rc_twopass_stats_in.buf = const_cast<char *>(stats.data());
+  cfg_.rc_twopass_stats_in.sz = stats.size();
+  InitEncoder(&enc);
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&enc, VP9E_SET_TWOPASS_CHUNK, 2));
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&enc, VP9E_SET_TWOPASS_CHUNK, -2));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_control(&enc, VP9E_SET_TWOPASS_CHUNK, 1));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&enc));
+}
+
+}  // namespace
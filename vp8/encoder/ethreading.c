@@ -14,6 +14,7 @@
 #include "vp8/common/extend.h"
 #include "bitstream.h"
 #include "encodeframe.h"
+#include "firstpass.h"
 
 #if CONFIG_MULTITHREAD
 
@@ -67,6 +68,16 @@ static THREAD_FUNCTION thread_encoding_proc(void *p_data) {
       /* we're shutting down */
       if (protected_read(&cpi->mt_mutex, &cpi->b_multi_threaded) == 0) break;
 
+      if (cpi->pass == 1) {
+        /* First pass: the row stats are merged by the main thread. */
+        for (mb_row = ithread + 1; mb_row < cm->mb_rows;
+             mb_row += (cpi->encoding_thread_count + 1)) {
+          vp8_first_pass_mb_row(cpi, x, mb_row);
+        }
+        sem_post(&cpi->h_event_end_encoding[ithread]);
+        continue;
+      }
+
       xd->mode_info_context = cm->mi + cm->mode_info_stride * (ithread + 1);
       xd->mode_info_stride = cm->mode_info_stride;
 
@@ -17,6 +17,7 @@ extern "C" {
 
 extern void vp8_init_first_pass(VP8_COMP *cpi);
 extern void vp8_first_pass(VP8_COMP *cpi);
+extern void vp8_first_pass_mb_row(VP8_COMP *cpi, MACROBLOCK *x, int mb_row);
 extern void vp8_end_first_pass(VP8_COMP *cpi);
 
 extern void vp8_init_second_pass(VP8_COMP *cpi);
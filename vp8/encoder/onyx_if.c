@@ -409,6 +409,9 @@ static void dealloc_compressor_data(VP8_COMP *cpi) {
   vpx_free(cpi->tplist);
   cpi->tplist = NULL;
 
+  vpx_free(cpi->fp_row_stats);
+  cpi->fp_row_stats = NULL;
+
   /* Delete last frame MV storage buffers */
   vpx_free(cpi->lfmv);
   cpi->lfmv = 0;
@@ -1209,6 +1212,10 @@ void vp8_alloc_compressor_data(VP8_COMP *cpi) {
   vpx_free(cpi->tplist);
   CHECK_MEM_ERROR(cpi->tplist, vpx_malloc(sizeof(TOKENLIST) * cm->mb_rows));
 
+  vpx_free(cpi->fp_row_stats);
+  CHECK_MEM_ERROR(cpi->fp_row_stats,
+                  vpx_malloc(sizeof(*cpi->fp_row_stats) * cm->mb_rows));
+
 #if CONFIG_TEMPORAL_DENOISING
   if (cpi->oxcf.noise_sensitivity > 0) {
     vp8_denoiser_free(&cpi->denoiser);
@@ -110,6 +110,31 @@ typedef struct {
   double count;
 } FIRSTPASS_STATS;
 
+/* First pass statistics of one macroblock row. The rows are encoded
+ * independently (possibly by several threads) and merged in row order.
+ */
+typedef struct {
+  int64_t intra_error;
+  int64_t coded_error;
+  int sum_mvr;
+  int sum_mvc;
+  int sum_mvr_abs;
+  int sum_mvc_abs;
+  int sum_mvrs;
+  int sum_mvcs;
+  int mvcount;
+  int intercount;
+  int second_ref_count;
+  int neutral_count;
+  int new_mv_count;
+  int sum_in_vectors;
+  /* First and last non-zero motion vectors of the row, used to count new
+   * motion vectors across row boundaries when merging.
+   */
+  uint32_t first_mv_as_int;
+  uint32_t last_mv_as_int;
+} FIRSTPASS_ROW_STATS;
+
 typedef struct {
   int frames_so_far;
   double frame_intra_error;
@@ -534,6 +559,7 @@ typedef struct VP8_COMP {
 #endif
 
   TOKENLIST *tplist;
+  FIRSTPASS_ROW_STATS *fp_row_stats;
   unsigned int partition_sz[MAX_PARTITIONS];
   unsigned char *partition_d[MAX_PARTITIONS];
   unsigned char *partition_d_end[MAX_PARTITIONS];
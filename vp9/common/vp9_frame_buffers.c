@@ -21,6 +21,7 @@ int vp9_alloc_internal_frame_buffers(InternalFrameBufferList *list) {
       VP9_MAXIMUM_REF_BUFFERS + VPX_MAXIMUM_WORK_BUFFERS;
   list->int_fb = (InternalFrameBuffer *)vpx_calloc(
       list->num_internal_frame_buffers, sizeof(*list->int_fb));
+  list->peak_size = 0;
   return (list->int_fb == NULL);
 }
 
@@ -35,38 +36,63 @@ void vp9_free_internal_frame_buffers(InternalFrameBufferList *list) {
   }
   vpx_free(list->int_fb);
   list->int_fb = NULL;
+  list->total_size = 0;
+}
+
+// Rounds |size| up to a multiple of 1/16 to 1/32 of itself, so that frame
+// sizes that differ a little share buffers, at most 1/16 larger.
+static size_t get_size_class(size_t size) {
+  size_t step = 1;
+  while ((step << 5) <= size) step <<= 1;
+  if (size > ~(size_t)0 - step) return size;
+  return (size + step - 1) & ~(step - 1);
 }
 
 int vp9_get_frame_buffer(void *cb_priv, size_t min_size,
                          vpx_codec_frame_buffer_t *fb) {
-  int i;
+  int i, fit = -1, grow = -1;
   InternalFrameBufferList *const int_fb_list =
       (InternalFrameBufferList *)cb_priv;
+  InternalFrameBuffer *int_fb;
   if (int_fb_list == NULL) return -1;
 
-  // Find a free frame buffer.
+  // Find the smallest free frame buffer that is large enough, which keeps the
+  // larger buffers for the frames that need them, or else the largest one.
   for (i = 0; i < int_fb_list->num_internal_frame_buffers; ++i) {
-    if (!int_fb_list->int_fb[i].in_use) break;
+    const InternalFrameBuffer *const buf = &int_fb_list->int_fb[i];
+    if (buf->in_use) continue;
+    if (buf->size >= min_size) {
+      if (fit < 0 || buf->size < int_fb_list->int_fb[fit].size) fit = i;
+    } else if (grow < 0 || buf->size > int_fb_list->int_fb[grow].size) {
+      grow = i;
+    }
   }
 
-  if (i == int_fb_list->num_internal_frame_buffers) return -1;
+  if (fit < 0 && grow < 0) return -1;
+  int_fb = &int_fb_list->int_fb[fit >= 0 ? fit : grow];
 
-  if (int_fb_list->int_fb[i].size < min_size) {
-    vpx_free(int_fb_list->int_fb[i].data);
-    // The data must be zeroed to fix a valgrind error from the C loop filter
-    // due to access uninitialized memory in frame border. It could be
-    // skipped if border were totally removed.
-    int_fb_list->int_fb[i].data = (uint8_t *)vpx_calloc(1, min_size);
-    if (!int_fb_list->int_fb[i].data) return -1;
-    int_fb_list->int_fb[i].size = min_size;
+  if (int_fb->size < min_size) {
+    const size_t size = get_size_class(min_size);
+    vpx_free(int_fb->data);
+    int_fb_list->total_size -= int_fb->size;
+    int_fb->size = 0;
+    // Decoded planes are written before they are read, so the data is not
+    // zeroed. vpx_realloc_frame_buffer() clears it for memory sanitizer
+    // builds, as the C loop filter reads the unused frame border.
+    int_fb->data = (uint8_t *)vpx_malloc(size);
+    if (!int_fb->data) return -1;
+    int_fb->size = size;
+    int_fb_list->total_size += size;
+    if (int_fb_list->total_size > int_fb_list->peak_size)
+      int_fb_list->peak_size = int_fb_list->total_size;
   }
 
-  fb->data = int_fb_list->int_fb[i].data;
-  fb->size = int_fb_list->int_fb[i].size;
-  int_fb_list->int_fb[i].in_use = 1;
+  fb->data = int_fb->data;
+  fb->size = int_fb->size;
+  int_fb->in_use = 1;
 
   // Set the frame buffer's private data to point at the internal frame buffer.
-  fb->priv = &int_fb_list->int_fb[i];
+  fb->priv = int_fb;
   return 0;
 }
 
@@ -27,6 +27,8 @@ typedef struct InternalFrameBuffer {
 typedef struct InternalFrameBufferList {
   int num_internal_frame_buffers;
   InternalFrameBuffer *int_fb;
+  size_t total_size;  // Bytes allocated to the frame buffers.
+  size_t peak_size;   // Largest total_size since the list was initialized.
 } InternalFrameBufferList;
 
 // Initializes |list|. Returns 0 on success.
@@ -38,7 +40,9 @@ void vp9_free_internal_frame_buffers(InternalFrameBufferList *list);
 // Callback used by libvpx to request an external frame buffer. |cb_priv|
 // Callback private data, which points to an InternalFrameBufferList.
 // |min_size| is the minimum size in bytes needed to decode the next frame.
-// |fb| pointer to the frame buffer.
+// |fb| pointer to the frame buffer. The smallest free buffer that holds
+// |min_size| bytes is used. If there is none the largest free buffer is
+// reallocated, rounded up to a size class. The data is not zeroed.
 int vp9_get_frame_buffer(void *cb_priv, size_t min_size,
                          vpx_codec_frame_buffer_t *fb);
 
@@ -13,6 +13,7 @@
 
 #include "./vpx_config.h"
 #include "vpx/internal/vpx_codec_internal.h"
+#include "vpx_ports/vpx_atomics.h"
 #include "vpx_util/vpx_thread.h"
 #include "./vp9_rtcd.h"
 #include "vp9/common/vp9_alloccommon.h"
@@ -75,6 +76,13 @@ typedef struct {
   vpx_codec_frame_buffer_t raw_frame_buffer;
   YV12_BUFFER_CONFIG buf;
 
+  // Luma area [valid_x_start, valid_x_end) x [0, valid_y_end) that matches a
+  // full decode when only a region of tiles was reconstructed. It covers the
+  // whole frame otherwise.
+  int valid_x_start;
+  int valid_x_end;
+  int valid_y_end;
+
   // The Following variables will only be used in frame parallel decode.
 
   // frame_worker_owner indicates which FrameWorker owns this buffer. NULL means
@@ -83,8 +91,9 @@ typedef struct {
 
   // row and col indicate which position frame has been decoded to in real
   // pixel unit. They are reset to -1 when decoding begins and set to INT_MAX
-  // when the frame is fully decoded.
-  int row;
+  // when the frame is fully decoded. row is read by other FrameWorkers
+  // without holding a lock.
+  vpx_atomic_int row;
   int col;
 } RefCntBuffer;
 
@@ -43,8 +43,6 @@
 #include "vp9/decoder/vp9_decoder.h"
 #include "vp9/decoder/vp9_dsubexp.h"
 
-#define MAX_VP9_HEADER_SIZE 80
-
 static int is_compound_reference_allowed(const VP9_COMMON *cm) {
   int i;
   for (i = 1; i < REFS_PER_FRAME; ++i)
@@ -181,6 +179,22 @@ static void read_mv_probs(nmv_context *ctx, int allow_hp, vpx_reader *r) {
   }
 }
 
+// Zeroes the coefficients written by vp9_decode_block_tokens() so dqcoeff is
+// clear for the next transform block.
+static INLINE void clear_dqcoeff(tran_low_t *dqcoeff, TX_TYPE tx_type,
+                                 TX_SIZE tx_size, int eob) {
+  if (eob == 1) {
+    dqcoeff[0] = 0;
+  } else {
+    if (tx_type == DCT_DCT && tx_size <= TX_16X16 && eob <= 10)
+      memset(dqcoeff, 0, 4 * (4 << tx_size) * sizeof(dqcoeff[0]));
+    else if (tx_size == TX_32X32 && eob <= 34)
+      memset(dqcoeff, 0, 256 * sizeof(dqcoeff[0]));
+    else
+      memset(dqcoeff, 0, (16 << (tx_size << 1)) * sizeof(dqcoeff[0]));
+  }
+}
+
 static void inverse_transform_block_inter(MACROBLOCKD *xd, int plane,
                                           const TX_SIZE tx_size, uint8_t *dst,
                                           int stride, int eob) {
@@ -235,16 +249,7 @@ static void inverse_transform_block_inter(MACROBLOCKD *xd, int plane,
   }
 #endif  // CONFIG_VP9_HIGHBITDEPTH
 
-  if (eob == 1) {
-    dqcoeff[0] = 0;
-  } else {
-    if (tx_size <= TX_16X16 && eob <= 10)
-      memset(dqcoeff, 0, 4 * (4 << tx_size) * sizeof(dqcoeff[0]));
-    else if (tx_size == TX_32X32 && eob <= 34)
-      memset(dqcoeff, 0, 256 * sizeof(dqcoeff[0]));
-    else
-      memset(dqcoeff, 0, (16 << (tx_size << 1)) * sizeof(dqcoeff[0]));
-  }
+  clear_dqcoeff(dqcoeff, DCT_DCT, tx_size, eob);
 }
 
 static void inverse_transform_block_intra(MACROBLOCKD *xd, int plane,
@@ -306,16 +311,30 @@ static void inverse_transform_block_intra(MACROBLOCKD *xd, int plane,
   }
 #endif  // CONFIG_VP9_HIGHBITDEPTH
 
-  if (eob == 1) {
-    dqcoeff[0] = 0;
-  } else {
-    if (tx_type == DCT_DCT && tx_size <= TX_16X16 && eob <= 10)
-      memset(dqcoeff, 0, 4 * (4 << tx_size) * sizeof(dqcoeff[0]));
-    else if (tx_size == TX_32X32 && eob <= 34)
-      memset(dqcoeff, 0, 256 * sizeof(dqcoeff[0]));
-    else
-      memset(dqcoeff, 0, (16 << (tx_size << 1)) * sizeof(dqcoeff[0]));
-  }
+  clear_dqcoeff(dqcoeff, tx_type, tx_size, eob);
+}
+
+// Keeps only the lowest frequencies of a DCT block for VP9_SET_FAST_PREVIEW and
+// returns the eob that selects the partial inverse transform covering them.
+// Only used for inter blocks, since in intra blocks the error would spread
+// through the prediction of the neighbouring blocks.
+static int drop_high_freqs(tran_low_t *dqcoeff, TX_SIZE tx_size, int eob,
+                           int level) {
+  // Size of the top-left corner kept, and the eob for it.
+  static const int keep_size[2][TX_SIZES] = { { 4, 4, 8, 16 }, { 1, 4, 4, 8 } };
+  static const int keep_eob[2][TX_SIZES] = { { 16, 12, 38, 135 },
+                                             { 1, 12, 10, 34 } };
+  const int n = 4 << tx_size;
+  const int k = keep_size[level - 1][tx_size];
+  int r;
+
+  // Smaller eobs only have coefficients in the corner.
+  if (eob <= keep_eob[level - 1][tx_size]) return eob;
+
+  for (r = 0; r < k; ++r)
+    memset(dqcoeff + r * n + k, 0, (n - k) * sizeof(dqcoeff[0]));
+  memset(dqcoeff + k * n, 0, (n - k) * n * sizeof(dqcoeff[0]));
+  return keep_eob[level - 1][tx_size];
 }
 
 static void predict_and_reconstruct_intra_block(TileWorkerData *twd,
@@ -359,9 +378,13 @@ static int reconstruct_inter_block(TileWorkerData *twd, MODE_INFO *const mi,
                                           mi->segment_id);
 
   if (eob > 0) {
+    const int recon_eob =
+        twd->preview_level && !xd->lossless
+            ? drop_high_freqs(pd->dqcoeff, tx_size, eob, twd->preview_level)
+            : eob;
     inverse_transform_block_inter(
         xd, plane, tx_size, &pd->dst.buf[4 * row * pd->dst.stride + 4 * col],
-        pd->dst.stride, eob);
+        pd->dst.stride, recon_eob);
   }
   return eob;
 }
@@ -492,12 +515,32 @@ static void extend_and_predict(const uint8_t *buf_ptr1, int pre_buf_stride,
 }
 #endif  // CONFIG_VP9_HIGHBITDEPTH
 
+// Leaves the block at luma position [bx0, bx1) x [by0, ...) out of the valid
+// area of the tile when it predicts from the area [x0, x1) x [0, y1) of
+// ref_buf, clamped to the frame like the border extension, and that area is
+// not known to match a full decode.
+static INLINE void check_ref_region(TileWorkerData *twd,
+                                    const RefCntBuffer *ref_buf, int x0, int x1,
+                                    int y1, int frame_width, int frame_height,
+                                    int bx0, int bx1, int by0) {
+  x0 = clamp(x0, 0, frame_width - 1);
+  x1 = clamp(x1, 1, frame_width);
+  y1 = clamp(y1, 1, frame_height);
+  if (x0 < ref_buf->valid_x_start)
+    twd->valid_x_start = VPXMAX(twd->valid_x_start, bx1);
+  if (x1 > ref_buf->valid_x_end)
+    twd->valid_x_end = VPXMIN(twd->valid_x_end, bx0);
+  if (y1 > ref_buf->valid_y_end)
+    twd->valid_y_end = VPXMIN(twd->valid_y_end, by0);
+}
+
 static void dec_build_inter_predictors(
-    VPxWorker *const worker, MACROBLOCKD *xd, int plane, int bw, int bh, int x,
-    int y, int w, int h, int mi_x, int mi_y, const InterpKernel *kernel,
+    VPxWorker *const worker, TileWorkerData *twd, int plane, int bw, int bh,
+    int x, int y, int w, int h, int mi_x, int mi_y, const InterpKernel *kernel,
     const struct scale_factors *sf, struct buf_2d *pre_buf,
     struct buf_2d *dst_buf, const MV *mv, RefCntBuffer *ref_frame_buf,
     int is_scaled, int ref) {
+  MACROBLOCKD *const xd = &twd->xd;
   struct macroblockd_plane *const pd = &xd->plane[plane];
   uint8_t *const dst = dst_buf->buf + dst_buf->stride * y + x;
   MV32 scaled_mv;
@@ -570,6 +613,15 @@ static void dec_build_inter_predictors(
   x0_16 += scaled_mv.col;
   y0_16 += scaled_mv.row;
 
+  if (twd->check_region && plane == 0) {
+    // Widen the filter reach to also cover the chroma planes.
+    const int x1 = ((x0_16 + (w - 1) * xs) >> SUBPEL_BITS) + 1;
+    const int y1 = ((y0_16 + (h - 1) * ys) >> SUBPEL_BITS) + 1;
+    check_ref_region(twd, ref_frame_buf, x0 - 2 * VP9_INTERP_EXTEND,
+                     x1 + 2 * VP9_INTERP_EXTEND, y1 + 2 * VP9_INTERP_EXTEND,
+                     frame_width, frame_height, mi_x, mi_x + bw, mi_y);
+  }
+
   // Get reference block pointer.
   buf_ptr = ref_frame + y0 * pre_buf->stride + x0;
   buf_stride = pre_buf->stride;
@@ -599,8 +651,9 @@ static void dec_build_inter_predictors(
     // Wait until reference block is ready. Pad 7 more pixels as last 7
     // pixels of each superblock row can be changed by next superblock row.
     if (worker != NULL)
-      vp9_frameworker_wait(worker, ref_frame_buf, VPXMAX(0, (y1 + 7))
-                                                      << (plane == 0 ? 0 : 1));
+      vp9_frameworker_wait(ref_frame_buf,
+                           VPXMAX(0, (y1 + 7)) << (plane == 0 ? 0 : 1),
+                           xd->error_info);
 
     // Skip border extension if block is inside the frame.
     if (x0 < 0 || x0 > frame_width - 1 || x1 < 0 || x1 > frame_width - 1 ||
@@ -625,8 +678,9 @@ static void dec_build_inter_predictors(
     // pixels of each superblock row can be changed by next superblock row.
     if (worker != NULL) {
       const int y1 = (y0_16 + (h - 1) * ys) >> SUBPEL_BITS;
-      vp9_frameworker_wait(worker, ref_frame_buf, VPXMAX(0, (y1 + 7))
-                                                      << (plane == 0 ? 0 : 1));
+      vp9_frameworker_wait(ref_frame_buf,
+                           VPXMAX(0, (y1 + 7)) << (plane == 0 ? 0 : 1),
+                           xd->error_info);
     }
   }
 #if CONFIG_VP9_HIGHBITDEPTH
@@ -644,8 +698,9 @@ static void dec_build_inter_predictors(
 }
 
 static void dec_build_inter_predictors_sb(VP9Decoder *const pbi,
-                                          MACROBLOCKD *xd, int mi_row,
+                                          TileWorkerData *twd, int mi_row,
                                           int mi_col) {
+  MACROBLOCKD *const xd = &twd->xd;
   int plane;
   const int mi_x = mi_col * MI_SIZE;
   const int mi_y = mi_row * MI_SIZE;
@@ -688,9 +743,9 @@ static void dec_build_inter_predictors_sb(VP9Decoder *const pbi,
         for (y = 0; y < num_4x4_h; ++y) {
           for (x = 0; x < num_4x4_w; ++x) {
             const MV mv = average_split_mvs(pd, mi, ref, i++);
-            dec_build_inter_predictors(fwo, xd, plane, n4w_x4, n4h_x4, 4 * x,
-                                       4 * y, 4, 4, mi_x, mi_y, kernel, sf,
-                                       pre_buf, dst_buf, &mv, ref_frame_buf,
+            dec_build_inter_predictors(fwo, twd, plane, n4w_x4, n4h_x4,
+                                       4 * x, 4 * y, 4, 4, mi_x, mi_y, kernel,
+                                       sf, pre_buf, dst_buf, &mv, ref_frame_buf,
                                        is_scaled, ref);
           }
         }
@@ -705,12 +760,65 @@ static void dec_build_inter_predictors_sb(VP9Decoder *const pbi,
         const int n4w_x4 = 4 * num_4x4_w;
         const int n4h_x4 = 4 * num_4x4_h;
         struct buf_2d *const pre_buf = &pd->pre[ref];
-        dec_build_inter_predictors(fwo, xd, plane, n4w_x4, n4h_x4, 0, 0, n4w_x4,
-                                   n4h_x4, mi_x, mi_y, kernel, sf, pre_buf,
-                                   dst_buf, &mv, ref_frame_buf, is_scaled, ref);
+        dec_build_inter_predictors(fwo, twd, plane, n4w_x4, n4h_x4, 0, 0,
+                                   n4w_x4, n4h_x4, mi_x, mi_y, kernel, sf,
+                                   pre_buf, dst_buf, &mv, ref_frame_buf,
+                                   is_scaled, ref);
+      }
+    }
+  }
+}
+
+// Reads the tokens of a block outside the tile region without reconstructing
+// it, keeping the entropy contexts and counts the same as a full decode.
+static void parse_block_tokens(TileWorkerData *twd, MODE_INFO *const mi,
+                               int less8x8) {
+  MACROBLOCKD *const xd = &twd->xd;
+  const int is_inter = is_inter_block(mi);
+  int eobtotal = 0;
+  int plane;
+
+  if (mi->skip) return;
+
+  for (plane = 0; plane < MAX_MB_PLANE; ++plane) {
+    struct macroblockd_plane *const pd = &xd->plane[plane];
+    const TX_SIZE tx_size = plane ? get_uv_tx_size(mi, pd) : mi->tx_size;
+    const int step = (1 << tx_size);
+    int row, col;
+    const int max_blocks_wide =
+        pd->n4_w + (xd->mb_to_right_edge >= 0
+                        ? 0
+                        : xd->mb_to_right_edge >> (5 + pd->subsampling_x));
+    const int max_blocks_high =
+        pd->n4_h + (xd->mb_to_bottom_edge >= 0
+                        ? 0
+                        : xd->mb_to_bottom_edge >> (5 + pd->subsampling_y));
+
+    xd->max_blocks_wide = xd->mb_to_right_edge >= 0 ? 0 : max_blocks_wide;
+    xd->max_blocks_high = xd->mb_to_bottom_edge >= 0 ? 0 : max_blocks_high;
+
+    for (row = 0; row < max_blocks_high; row += step) {
+      for (col = 0; col < max_blocks_wide; col += step) {
+        TX_TYPE tx_type = DCT_DCT;
+        const scan_order *sc = &vp9_default_scan_orders[tx_size];
+        int eob;
+
+        if (!is_inter && !plane && !xd->lossless) {
+          const PREDICTION_MODE mode =
+              mi->sb_type < BLOCK_8X8 ? mi->bmi[(row << 1) + col].as_mode
+                                      : mi->mode;
+          tx_type = intra_mode_to_tx_type_lookup[mode];
+          sc = &vp9_scan_orders[tx_size][tx_type];
+        }
+        eob = vp9_decode_block_tokens(twd, plane, sc, col, row, tx_size,
+                                      mi->segment_id);
+        if (eob > 0) clear_dqcoeff(pd->dqcoeff, tx_type, tx_size, eob);
+        eobtotal += eob;
       }
     }
   }
+
+  if (is_inter && !less8x8 && eobtotal == 0) mi->skip = 1;
 }
 
 static INLINE void dec_reset_skip_context(MACROBLOCKD *xd) {
@@ -790,8 +898,14 @@ static void decode_block(TileWorkerData *twd, VP9Decoder *const pbi, int mi_row,
     dec_reset_skip_context(xd);
   }
 
-  if (!is_inter_block(mi)) {
+  if (twd->parse_only) {
+    parse_block_tokens(twd, mi, less8x8);
+  } else if (!is_inter_block(mi)) {
     int plane;
+    // Intra prediction carries a mismatch on the left into this block.
+    if (twd->check_region && xd->left_mi != NULL &&
+        mi_col * MI_SIZE <= twd->valid_x_start)
+      twd->valid_x_start = VPXMAX(twd->valid_x_start, (mi_col + bw) * MI_SIZE);
     for (plane = 0; plane < MAX_MB_PLANE; ++plane) {
       const struct macroblockd_plane *const pd = &xd->plane[plane];
       const TX_SIZE tx_size = plane ? get_uv_tx_size(mi, pd) : mi->tx_size;
@@ -818,7 +932,7 @@ static void decode_block(TileWorkerData *twd, VP9Decoder *const pbi, int mi_row,
     }
   } else {
     // Prediction
-    dec_build_inter_predictors_sb(pbi, xd, mi_row, mi_col);
+    dec_build_inter_predictors_sb(pbi, twd, mi_row, mi_col);
 
     // Reconstruction
     if (!mi->skip) {
@@ -857,7 +971,7 @@ static void decode_block(TileWorkerData *twd, VP9Decoder *const pbi, int mi_row,
 
   xd->corrupted |= vpx_reader_has_error(r);
 
-  if (cm->lf.filter_level) {
+  if (cm->lf.filter_level && !twd->parse_only) {
     vp9_build_mask(cm, mi, mi_row, mi_col, bw, bh);
   }
 }
@@ -1005,6 +1119,22 @@ static void read_coef_probs(FRAME_CONTEXT *fc, TX_MODE tx_mode, vpx_reader *r) {
     read_coef_probs_common(fc->coef_probs[tx_size], r);
 }
 
+// Fills pbi->coef_probs for the transform sizes allowed by tx_mode.
+static void expand_coef_probs(VP9Decoder *pbi, TX_MODE tx_mode) {
+  const FRAME_CONTEXT *const fc = pbi->common.fc;
+  const TX_SIZE max_tx_size = tx_mode_to_biggest_tx_size[tx_mode];
+  TX_SIZE tx_size;
+  int i, j, k, l;
+
+  for (tx_size = TX_4X4; tx_size <= max_tx_size; ++tx_size)
+    for (i = 0; i < PLANE_TYPES; ++i)
+      for (j = 0; j < REF_TYPES; ++j)
+        for (k = 0; k < COEF_BANDS; ++k)
+          for (l = 0; l < BAND_COEFF_CONTEXTS(k); ++l)
+            vp9_model_to_full_probs(fc->coef_probs[tx_size][i][j][k][l],
+                                    pbi->coef_probs[tx_size][i][j][k][l]);
+}
+
 static void setup_segmentation(struct segmentation *seg,
                                struct vpx_read_bit_buffer *rb) {
   int i, j;
@@ -1353,23 +1483,139 @@ static void get_tile_buffer(const uint8_t *const data_end, int is_last,
   *data += size;
 }
 
-static void get_tile_buffers(VP9Decoder *pbi, const uint8_t *data,
-                             const uint8_t *data_end, int tile_cols,
-                             int tile_rows,
-                             TileBuffer (*tile_buffers)[1 << 6]) {
-  int r, c;
+// Blocks until the input up to 'end' has arrived, see VP9D_SET_INPUT_WAIT.
+static void wait_for_input(VP9Decoder *pbi, const uint8_t *end) {
+  const size_t size = (size_t)(end - pbi->input_start);
+  if (pbi->input_wait_cb == NULL || size <= pbi->input_received) return;
+  if (pbi->input_wait_cb(pbi->input_wait_state, size))
+    vpx_internal_error(&pbi->common.error, VPX_CODEC_CORRUPT_FRAME,
+                       "Failed to receive frame data");
+  pbi->input_received = size;
+}
 
-  for (r = 0; r < tile_rows; ++r) {
-    for (c = 0; c < tile_cols; ++c) {
-      const int is_last = (r == tile_rows - 1) && (c == tile_cols - 1);
-      TileBuffer *const buf = &tile_buffers[r][c];
-      buf->col = c;
-      get_tile_buffer(data_end, is_last, &pbi->common.error, &data,
-                      pbi->decrypt_cb, pbi->decrypt_state, buf);
+// Like get_tile_buffer(), but waits until all of the tile has arrived.
+static void read_tile_buffer(VP9Decoder *pbi, const uint8_t *const data_end,
+                             int is_last, const uint8_t **data,
+                             TileBuffer *buf) {
+  if (!is_last) wait_for_input(pbi, VPXMIN(*data + 4, data_end));
+  get_tile_buffer(data_end, is_last, &pbi->common.error, data,
+                  pbi->decrypt_cb, pbi->decrypt_state, buf);
+  wait_for_input(pbi, buf->data + buf->size);
+}
+
+// Reads the buffers of the tiles in 'tile_row' and returns the start of the
+// next tile row.
+static const uint8_t *get_tile_buffers(VP9Decoder *pbi, const uint8_t *data,
+                                       const uint8_t *data_end, int tile_row,
+                                       TileBuffer *tile_buffers) {
+  const VP9_COMMON *const cm = &pbi->common;
+  const int tile_cols = 1 << cm->log2_tile_cols;
+  const int last_row = tile_row == (1 << cm->log2_tile_rows) - 1;
+  int c;
+
+  for (c = 0; c < tile_cols; ++c) {
+    TileBuffer *const buf = &tile_buffers[c];
+    buf->col = c;
+    read_tile_buffer(pbi, data_end, last_row && c == tile_cols - 1, &data,
+                     buf);
+  }
+  return data;
+}
+
+// Resolves pbi->tile_region against the tiles of the current frame. The valid
+// area of the new frame starts as the region and is narrowed by the tiles,
+// see finish_tile_region().
+static void setup_tile_region(VP9Decoder *pbi) {
+  VP9_COMMON *const cm = &pbi->common;
+  RefCntBuffer *const cur_frame = cm->cur_frame;
+  const vpx_tile_region_t *const region = &pbi->tile_region;
+  const int last_col = (1 << cm->log2_tile_cols) - 1;
+  const int last_row = (1 << cm->log2_tile_rows) - 1;
+  TileInfo tile;
+  int x_start, x_end, y_end;
+
+  pbi->region_col_start = 0;
+  pbi->region_col_end = last_col;
+  pbi->region_row_end = last_row;
+  if (!pbi->frame_parallel_decode) {
+    if (region->col_end >= 0)
+      pbi->region_col_end = VPXMIN(region->col_end, last_col);
+    pbi->region_col_start = clamp(region->col_start, 0, pbi->region_col_end);
+    if (region->row_end >= 0)
+      pbi->region_row_end = VPXMIN(region->row_end, last_row);
+  }
+
+  vp9_tile_set_col(&tile, cm, pbi->region_col_start);
+  x_start = tile.mi_col_start * MI_SIZE;
+  vp9_tile_set_col(&tile, cm, pbi->region_col_end);
+  x_end = VPXMIN(tile.mi_col_end * MI_SIZE, cm->width);
+  vp9_tile_set_row(&tile, cm, pbi->region_row_end);
+  y_end = VPXMIN(tile.mi_row_end * MI_SIZE, cm->height);
+
+  cur_frame->valid_x_start = x_start;
+  cur_frame->valid_x_end = x_end;
+  cur_frame->valid_y_end = y_end;
+
+  // Blocks only need to check their reference areas when something was left
+  // out of this frame or of one of its references.
+  pbi->check_region = x_start > 0 || x_end < cm->width || y_end < cm->height;
+  if (!frame_is_intra_only(cm)) {
+    int i;
+    for (i = 0; i < REFS_PER_FRAME; ++i) {
+      const RefCntBuffer *const ref_buf =
+          &cm->buffer_pool->frame_bufs[cm->frame_refs[i].idx];
+      pbi->check_region |= ref_buf->valid_x_start > 0 ||
+                           ref_buf->valid_x_end < ref_buf->buf.y_crop_width ||
+                           ref_buf->valid_y_end < ref_buf->buf.y_crop_height;
     }
   }
 }
 
+static void init_tile_region(TileWorkerData *twd, const VP9Decoder *pbi) {
+  const RefCntBuffer *const cur_frame = pbi->common.cur_frame;
+  twd->check_region = pbi->check_region;
+  twd->valid_x_start = cur_frame->valid_x_start;
+  twd->valid_x_end = cur_frame->valid_x_end;
+  twd->valid_y_end = cur_frame->valid_y_end;
+}
+
+static void merge_tile_region(RefCntBuffer *cur_frame,
+                              const TileWorkerData *twd) {
+  cur_frame->valid_x_start =
+      VPXMAX(cur_frame->valid_x_start, twd->valid_x_start);
+  cur_frame->valid_x_end = VPXMIN(cur_frame->valid_x_end, twd->valid_x_end);
+  cur_frame->valid_y_end = VPXMIN(cur_frame->valid_y_end, twd->valid_y_end);
+}
+
+// The loop filter changes up to 7 pixels on each side of an edge, which is 14
+// luma pixels in subsampled chroma planes, so it spreads any mismatch that far
+// into the valid area.
+static void finish_tile_region(VP9_COMMON *cm) {
+  RefCntBuffer *const cur_frame = cm->cur_frame;
+  if (cur_frame->valid_x_start > 0) cur_frame->valid_x_start += 16;
+  if (cur_frame->valid_x_end < cm->width) cur_frame->valid_x_end -= 16;
+  if (cur_frame->valid_y_end < cm->height) cur_frame->valid_y_end -= 16;
+}
+
+static INLINE int reconstruct_tile(const VP9Decoder *pbi, int tile_row,
+                                   int tile_col) {
+  return !pbi->skip_recon && tile_col >= pbi->region_col_start &&
+         tile_col <= pbi->region_col_end && tile_row <= pbi->region_row_end;
+}
+
+// Passes the rows of the new frame above 'y_end' that were not reported yet to
+// pbi->rows_done_cb.
+static void report_rows(VP9Decoder *pbi, int y_end) {
+  VP9_COMMON *const cm = &pbi->common;
+  const YV12_BUFFER_CONFIG *const buf = get_frame_new_buffer(cm);
+  y_end = VPXMIN(y_end, buf->y_crop_height);
+  if (pbi->rows_done_cb == NULL || !cm->show_frame || pbi->skip_recon ||
+      y_end <= pbi->rows_done)
+    return;
+  pbi->rows_done_cb(pbi->rows_done_priv, buf, pbi->rows_done, y_end);
+  pbi->rows_done = y_end;
+}
+
 static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
                                    const uint8_t *data_end) {
   VP9_COMMON *const cm = &pbi->common;
@@ -1381,13 +1627,16 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
   int tile_row, tile_col;
   int mi_row, mi_col;
   TileWorkerData *tile_data = NULL;
+  // In frame parallel mode the loop filter runs inline so that the progress
+  // broadcast after each superblock row only covers filtered pixels.
+  const int lf_async = pbi->max_threads > 1 && !pbi->frame_parallel_decode;
 
   if (cm->lf.filter_level && !cm->skip_loop_filter &&
       pbi->lf_worker.data1 == NULL) {
     CHECK_MEM_ERROR(cm, pbi->lf_worker.data1,
                     vpx_memalign(32, sizeof(LFWorkerData)));
     pbi->lf_worker.hook = (VPxWorkerHook)vp9_loop_filter_worker;
-    if (pbi->max_threads > 1 && !winterface->reset(&pbi->lf_worker)) {
+    if (lf_async && !winterface->reset(&pbi->lf_worker)) {
       vpx_internal_error(&cm->error, VPX_CODEC_ERROR,
                          "Loop filter thread creation failed");
     }
@@ -1414,15 +1663,23 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
 
   vp9_reset_lfm(cm);
 
-  get_tile_buffers(pbi, data, data_end, tile_cols, tile_rows, tile_buffers);
-
-  // Load all tile information into tile_data.
   for (tile_row = 0; tile_row < tile_rows; ++tile_row) {
+    TileInfo tile;
+    vp9_tile_set_row(&tile, cm, tile_row);
+
+    // Load the tile information of the row into tile_data. The rows are read
+    // one at a time so that streaming input is decoded as it arrives.
+    data = get_tile_buffers(pbi, data, data_end, tile_row,
+                            tile_buffers[tile_row]);
     for (tile_col = 0; tile_col < tile_cols; ++tile_col) {
       const TileBuffer *const buf = &tile_buffers[tile_row][tile_col];
       tile_data = pbi->tile_worker_data + tile_cols * tile_row + tile_col;
       tile_data->xd = pbi->mb;
       tile_data->xd.corrupted = 0;
+      tile_data->coef_probs = pbi->coef_probs;
+      tile_data->preview_level = pbi->preview_level;
+      tile_data->parse_only = !reconstruct_tile(pbi, tile_row, tile_col);
+      init_tile_region(tile_data, pbi);
       tile_data->xd.counts =
           cm->frame_parallel_decoding_mode ? NULL : &cm->counts;
       vp9_zero(tile_data->dqcoeff);
@@ -1432,11 +1689,7 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
                           pbi->decrypt_state);
       vp9_init_macroblockd(cm, &tile_data->xd, tile_data->dqcoeff);
     }
-  }
 
-  for (tile_row = 0; tile_row < tile_rows; ++tile_row) {
-    TileInfo tile;
-    vp9_tile_set_row(&tile, cm, tile_row);
     for (mi_row = tile.mi_row_start; mi_row < tile.mi_row_end;
          mi_row += MI_BLOCK_SIZE) {
       for (tile_col = 0; tile_col < tile_cols; ++tile_col) {
@@ -1467,13 +1720,18 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
         if (mi_row + MI_BLOCK_SIZE >= cm->mi_rows) continue;
 
         winterface->sync(&pbi->lf_worker);
+        // Filtering the next rows changes up to 7 pixels above them, which
+        // is 14 luma rows in subsampled chroma planes.
+        report_rows(pbi, (lf_data->stop << MI_SIZE_LOG2) - 16);
         lf_data->start = lf_start;
         lf_data->stop = mi_row;
-        if (pbi->max_threads > 1) {
+        if (lf_async) {
           winterface->launch(&pbi->lf_worker);
         } else {
           winterface->execute(&pbi->lf_worker);
         }
+      } else {
+        report_rows(pbi, (mi_row + MI_BLOCK_SIZE) << MI_SIZE_LOG2);
       }
       // After loopfiltering, the last 7 row pixels in each superblock row may
       // still be changed by the longest loopfilter of the next superblock
@@ -1492,6 +1750,13 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
     winterface->execute(&pbi->lf_worker);
   }
 
+  for (tile_row = 0; tile_row < tile_rows; ++tile_row) {
+    for (tile_col = 0; tile_col < tile_cols; ++tile_col) {
+      tile_data = pbi->tile_worker_data + tile_cols * tile_row + tile_col;
+      merge_tile_region(cm->cur_frame, tile_data);
+    }
+  }
+
   // Get last tile data.
   tile_data = pbi->tile_worker_data + tile_cols * tile_rows - 1;
 
@@ -1525,6 +1790,7 @@ static int tile_worker_hook(TileWorkerData *const tile_data,
     const TileBuffer *const buf = pbi->tile_buffers + n;
     vp9_zero(tile_data->dqcoeff);
     vp9_tile_init(tile, &pbi->common, 0, buf->col);
+    tile_data->parse_only = !reconstruct_tile(pbi, 0, buf->col);
     setup_token_decoder(buf->data, tile_data->data_end, buf->size,
                         &tile_data->error_info, &tile_data->bit_reader,
                         pbi->decrypt_cb, pbi->decrypt_state);
@@ -1598,6 +1864,9 @@ static const uint8_t *decode_tiles_mt(VP9Decoder *pbi, const uint8_t *data,
     tile_data->xd = pbi->mb;
     tile_data->xd.counts =
         cm->frame_parallel_decoding_mode ? NULL : &tile_data->counts;
+    tile_data->coef_probs = pbi->coef_probs;
+    tile_data->preview_level = pbi->preview_level;
+    init_tile_region(tile_data, pbi);
     worker->hook = (VPxWorkerHook)tile_worker_hook;
     worker->data1 = tile_data;
     worker->data2 = pbi;
@@ -1612,35 +1881,37 @@ static const uint8_t *decode_tiles_mt(VP9Decoder *pbi, const uint8_t *data,
 
   vp9_reset_lfm(cm);
 
-  // Load tile data into tile_buffers
-  get_tile_buffers(pbi, data, data_end, tile_cols, tile_rows,
-                   &pbi->tile_buffers);
-
-  // Sort the buffers based on size in descending order.
-  qsort(pbi->tile_buffers, tile_cols, sizeof(pbi->tile_buffers[0]),
-        compare_tile_buffers);
-
-  if (num_workers == tile_cols) {
-    // Rearrange the tile buffers such that the largest, and
-    // presumably the most difficult, tile will be decoded in the main thread.
-    // This should help minimize the number of instances where the main thread
-    // is waiting for a worker to complete.
-    const TileBuffer largest = pbi->tile_buffers[0];
-    memmove(pbi->tile_buffers, pbi->tile_buffers + 1,
-            (tile_cols - 1) * sizeof(pbi->tile_buffers[0]));
-    pbi->tile_buffers[tile_cols - 1] = largest;
-  } else {
-    int start = 0, end = tile_cols - 2;
-    TileBuffer tmp;
-
-    // Interleave the tiles to distribute the load between threads, assuming a
-    // larger tile implies it is more difficult to decode.
-    while (start < end) {
-      tmp = pbi->tile_buffers[start];
-      pbi->tile_buffers[start] = pbi->tile_buffers[end];
-      pbi->tile_buffers[end] = tmp;
-      start += 2;
-      end -= 2;
+  // Load tile data into tile_buffers. Streaming input keeps the tiles in
+  // bitstream order, and they are read below as each worker is started.
+  if (pbi->input_wait_cb == NULL) {
+    get_tile_buffers(pbi, data, data_end, 0, pbi->tile_buffers);
+
+    // Sort the buffers based on size in descending order.
+    qsort(pbi->tile_buffers, tile_cols, sizeof(pbi->tile_buffers[0]),
+          compare_tile_buffers);
+
+    if (num_workers == tile_cols) {
+      // Rearrange the tile buffers such that the largest, and presumably the
+      // most difficult, tile will be decoded in the main thread. This should
+      // help minimize the number of instances where the main thread is
+      // waiting for a worker to complete.
+      const TileBuffer largest = pbi->tile_buffers[0];
+      memmove(pbi->tile_buffers, pbi->tile_buffers + 1,
+              (tile_cols - 1) * sizeof(pbi->tile_buffers[0]));
+      pbi->tile_buffers[tile_cols - 1] = largest;
+    } else {
+      int start = 0, end = tile_cols - 2;
+      TileBuffer tmp;
+
+      // Interleave the tiles to distribute the load between threads,
+      // assuming a larger tile implies it is more difficult to decode.
+      while (start < end) {
+        tmp = pbi->tile_buffers[start];
+        pbi->tile_buffers[start] = pbi->tile_buffers[end];
+        pbi->tile_buffers[end] = tmp;
+        start += 2;
+        end -= 2;
+      }
     }
   }
 
@@ -1668,6 +1939,16 @@ static const uint8_t *decode_tiles_mt(VP9Decoder *pbi, const uint8_t *data,
       tile_data->data_end = data_end;
       buf_start += count;
 
+      if (pbi->input_wait_cb != NULL) {
+        // Start the worker once all of its tiles have arrived.
+        int i;
+        for (i = tile_data->buf_start; i <= tile_data->buf_end; ++i) {
+          TileBuffer *const buf = &pbi->tile_buffers[i];
+          buf->col = i;
+          read_tile_buffer(pbi, data_end, i == tile_cols - 1, &data, buf);
+        }
+      }
+
       worker->had_error = 0;
       if (n == num_workers - 1) {
         assert(tile_data->buf_end == tile_cols - 1);
@@ -1685,6 +1966,7 @@ static const uint8_t *decode_tiles_mt(VP9Decoder *pbi, const uint8_t *data,
       // in cm. Additionally once the threads have been synced and an error is
       // detected, there's no point in continuing to decode tiles.
       pbi->mb.corrupted |= !winterface->sync(worker);
+      merge_tile_region(cm->cur_frame, tile_data);
       if (!bit_reader_end) bit_reader_end = tile_data->data_end;
     }
   }
@@ -1972,6 +2254,7 @@ static int read_compressed_header(VP9Decoder *pbi, const uint8_t *data,
   cm->tx_mode = xd->lossless ? ONLY_4X4 : read_tx_mode(&r);
   if (cm->tx_mode == TX_MODE_SELECT) read_tx_mode_probs(&fc->tx_probs, &r);
   read_coef_probs(fc, cm->tx_mode, &r);
+  expand_coef_probs(pbi, cm->tx_mode);
 
   for (k = 0; k < SKIP_CONTEXTS; ++k)
     vp9_diff_update_prob(&r, &fc->skip_probs[k]);
@@ -2045,6 +2328,33 @@ BITSTREAM_PROFILE vp9_read_profile(struct vpx_read_bit_buffer *rb) {
   return (BITSTREAM_PROFILE)profile;
 }
 
+static void ignore_read_error(void *data) { (void)data; }
+
+int vp9_frame_is_sync_point(VP9Decoder *pbi, const uint8_t *data,
+                            const uint8_t *data_end) {
+  struct vpx_read_bit_buffer rb;
+  uint8_t clear_data[MAX_VP9_HEADER_SIZE];
+  int show_frame, error_resilient_mode;
+
+  // A truncated header reads as zeros, that is as a key frame, which leaves
+  // reporting the error to vp9_decode_frame().
+  init_read_bit_buffer(pbi, &rb, data, data_end, clear_data);
+  rb.error_handler = ignore_read_error;
+
+  if (vpx_rb_read_literal(&rb, 2) != VP9_FRAME_MARKER) return 1;
+  vp9_read_profile(&rb);
+  if (vpx_rb_read_bit(&rb)) return 0;  // show_existing_frame
+  if (vpx_rb_read_bit(&rb) == KEY_FRAME) return 1;
+
+  show_frame = vpx_rb_read_bit(&rb);
+  error_resilient_mode = vpx_rb_read_bit(&rb);
+  if (show_frame || !vpx_rb_read_bit(&rb)) return 0;  // not intra-only
+
+  // The frame context the intra-only frame uses must be reset, see
+  // vp9_setup_past_independence().
+  return error_resilient_mode || vpx_rb_read_literal(&rb, 2) >= 2;
+}
+
 void vp9_decode_frame(VP9Decoder *pbi, const uint8_t *data,
                       const uint8_t *data_end, const uint8_t **p_data_end) {
   VP9_COMMON *const cm = &pbi->common;
@@ -2059,9 +2369,29 @@ void vp9_decode_frame(VP9Decoder *pbi, const uint8_t *data,
   YV12_BUFFER_CONFIG *const new_fb = get_frame_new_buffer(cm);
   xd->cur_buf = new_fb;
 
+  // In preview mode frames that are not used as a reference are only parsed,
+  // as later frames need their entropy contexts and motion vectors, and are
+  // not output.
+  pbi->skip_recon = pbi->preview_level && first_partition_size &&
+                    !pbi->refresh_frame_flags && !pbi->frame_parallel_decode;
+
+  // A frame that refreshes no reference only affects later frames through
+  // the entropy contexts and segmentation map it carries over, and through
+  // its motion vectors. The next frame predicts from those unless the stream
+  // is error resilient or the frame is not shown, see the check below.
+  pbi->dropped = pbi->drop_non_ref && first_partition_size &&
+                 !pbi->refresh_frame_flags && !pbi->frame_parallel_decode &&
+                 !cm->intra_only &&
+                 (cm->error_resilient_mode || !cm->show_frame) &&
+                 (!cm->refresh_frame_context ||
+                  cm->frame_parallel_decoding_mode) &&
+                 !(cm->seg.enabled && cm->seg.update_map);
+
+  pbi->rows_done = 0;
   if (!first_partition_size) {
     // showing a frame directly
     *p_data_end = data + (cm->profile <= PROFILE_2 ? 1 : 2);
+    report_rows(pbi, INT_MAX);
     return;
   }
 
@@ -2069,14 +2399,21 @@ void vp9_decode_frame(VP9Decoder *pbi, const uint8_t *data,
   if (!read_is_valid(data, first_partition_size, data_end))
     vpx_internal_error(&cm->error, VPX_CODEC_CORRUPT_FRAME,
                        "Truncated packet or corrupt header length");
+  wait_for_input(pbi, data + first_partition_size);
 
   cm->use_prev_frame_mvs =
       !cm->error_resilient_mode && cm->width == cm->last_width &&
       cm->height == cm->last_height && !cm->last_intra_only &&
       cm->last_show_frame && (cm->last_frame_type != KEY_FRAME);
+  if (cm->use_prev_frame_mvs && cm->prev_frame == NULL)
+    vpx_internal_error(&cm->error, VPX_CODEC_CORRUPT_FRAME,
+                       "Frame predicts from the motion vectors of a dropped "
+                       "frame");
 
   vp9_setup_block_planes(xd, cm->subsampling_x, cm->subsampling_y);
 
+  setup_tile_region(pbi);
+
   *cm->fc = cm->frame_contexts[cm->frame_context_idx];
   if (!cm->fc->initialized)
     vpx_internal_error(&cm->error, VPX_CODEC_CORRUPT_FRAME,
@@ -2088,6 +2425,14 @@ void vp9_decode_frame(VP9Decoder *pbi, const uint8_t *data,
     vpx_internal_error(&cm->error, VPX_CODEC_CORRUPT_FRAME,
                        "Decode failed. Frame data header is corrupted.");
 
+  if (pbi->dropped) {
+    // Only the forward updates of the frame context are kept.
+    if (cm->refresh_frame_context)
+      cm->frame_contexts[cm->frame_context_idx] = *cm->fc;
+    *p_data_end = data_end;
+    return;
+  }
+
   if (cm->lf.filter_level && !cm->skip_loop_filter) {
     vp9_loop_filter_frame_init(cm, cm->lf.filter_level);
   }
@@ -2102,7 +2447,7 @@ void vp9_decode_frame(VP9Decoder *pbi, const uint8_t *data,
       cm->frame_contexts[cm->frame_context_idx] = *cm->fc;
     }
     vp9_frameworker_lock_stats(worker);
-    pbi->cur_buf->row = -1;
+    vpx_atomic_store(&pbi->cur_buf->row, -1);
     pbi->cur_buf->col = -1;
     frame_worker_data->frame_context_ready = 1;
     // Signal the main thread that context is ready.
@@ -2134,6 +2479,8 @@ void vp9_decode_frame(VP9Decoder *pbi, const uint8_t *data,
                                  0, 0, pbi->tile_workers, pbi->num_tile_workers,
                                  &pbi->lf_row_sync);
       }
+      if (pbi->frame_parallel_decode)
+        vp9_frameworker_broadcast(pbi->cur_buf, INT_MAX);
     } else {
       vpx_internal_error(&cm->error, VPX_CODEC_CORRUPT_FRAME,
                          "Decode failed. Frame data is corrupted.");
@@ -2141,6 +2488,8 @@ void vp9_decode_frame(VP9Decoder *pbi, const uint8_t *data,
   } else {
     *p_data_end = decode_tiles(pbi, data + first_partition_size, data_end);
   }
+  report_rows(pbi, INT_MAX);
+  finish_tile_region(cm);
 
   if (!xd->corrupted) {
     if (!cm->error_resilient_mode && !cm->frame_parallel_decoding_mode) {
@@ -17,6 +17,9 @@ extern "C" {
 
 #include "vp9/common/vp9_enums.h"
 
+// Upper bound on the size of the uncompressed frame header.
+#define MAX_VP9_HEADER_SIZE 80
+
 struct VP9Decoder;
 struct vpx_read_bit_buffer;
 
@@ -25,6 +28,11 @@ void vp9_read_frame_size(struct vpx_read_bit_buffer *rb, int *width,
                          int *height);
 BITSTREAM_PROFILE vp9_read_profile(struct vpx_read_bit_buffer *rb);
 
+// Returns 1 if the frame can be decoded without the state left by earlier
+// frames: a key frame, or an intra-only frame that resets its entropy context.
+int vp9_frame_is_sync_point(struct VP9Decoder *pbi, const uint8_t *data,
+                            const uint8_t *data_end);
+
 void vp9_decode_frame(struct VP9Decoder *pbi, const uint8_t *data,
                       const uint8_t *data_end, const uint8_t **p_data_end);
 
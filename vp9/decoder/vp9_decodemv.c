@@ -455,10 +455,18 @@ static void dec_find_best_ref_mvs(int allow_hp, int_mv *mvlist, int_mv *best_mv,
   }
 }
 
+// Frame parallel sync data. The error is reported to the calling thread's
+// error_info, which differs from the frame's when tiles are decoded in
+// parallel.
+typedef struct {
+  RefCntBuffer *prev_frame;
+  struct vpx_internal_error_info *error_info;
+} FpmSyncData;
+
 static void fpm_sync(void *const data, int mi_row) {
-  VP9Decoder *const pbi = (VP9Decoder *)data;
-  vp9_frameworker_wait(pbi->frame_worker_owner, pbi->common.prev_frame,
-                       mi_row << MI_BLOCK_SIZE_LOG2);
+  const FpmSyncData *const sync_data = (const FpmSyncData *)data;
+  vp9_frameworker_wait(sync_data->prev_frame, mi_row << MI_BLOCK_SIZE_LOG2,
+                       sync_data->error_info);
 }
 
 // This macro is used to add a motion vector mv_ref list if it isn't
@@ -557,16 +565,6 @@ static int dec_find_mv_refs(const VP9_COMMON *cm, const MACROBLOCKD *xd,
     }
   }
 
-// TODO(hkuang): Remove this sync after fixing pthread_cond_broadcast
-// on windows platform. The sync here is unnecessary if use_prev_frame_mvs
-// is 0. But after removing it, there will be hang in the unit test on windows
-// due to several threads waiting for a thread's signal.
-#if defined(_WIN32) && !HAVE_PTHREAD_H
-  if (cm->frame_parallel_decode && sync != NULL) {
-    sync(data, mi_row);
-  }
-#endif
-
   // Check the last frame's mode and mv info.
   if (prev_frame_mvs) {
     // Synchronize here for frame parallel decode if sync function is provided.
@@ -745,6 +743,9 @@ static void read_inter_block_mode_info(VP9Decoder *const pbi,
       mi->mode = NEARESTMV;
 
     if (mi->mode != ZEROMV) {
+      FpmSyncData sync_data;
+      sync_data.prev_frame = cm->prev_frame;
+      sync_data.error_info = xd->error_info;
       for (ref = 0; ref < 1 + is_compound; ++ref) {
         int_mv tmp_mvs[MAX_MV_REF_CANDIDATES];
         const MV_REFERENCE_FRAME frame = mi->ref_frame[ref];
@@ -752,7 +753,7 @@ static void read_inter_block_mode_info(VP9Decoder *const pbi,
 
         refmv_count =
             dec_find_mv_refs(cm, xd, mi->mode, frame, mv_ref_search, tmp_mvs,
-                             mi_row, mi_col, -1, 0, fpm_sync, (void *)pbi);
+                             mi_row, mi_col, -1, 0, fpm_sync, &sync_data);
 
         dec_find_best_ref_mvs(allow_hp, tmp_mvs, &best_ref_mvs[ref],
                               refmv_count);
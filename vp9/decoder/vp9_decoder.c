@@ -102,6 +102,9 @@ VP9Decoder *vp9_decoder_create(BufferPool *const pool) {
   cm->current_video_frame = 0;
   pbi->ready_for_new_data = 1;
   pbi->common.buffer_pool = pool;
+  pbi->tile_region.col_start = 0;
+  pbi->tile_region.col_end = -1;
+  pbi->tile_region.row_end = -1;
 
   cm->bit_depth = VPX_BITS_8;
   cm->dequant_bit_depth = VPX_BITS_8;
@@ -217,7 +220,11 @@ vpx_codec_err_t vp9_set_reference_dec(VP9_COMMON *cm,
                        "Incorrect buffer dimensions");
   } else {
     // Overwrite the reference frame buffer.
+    RefCntBuffer *const frame_buf = &cm->buffer_pool->frame_bufs[idx];
     vp8_yv12_copy_frame(sd, ref_buf);
+    frame_buf->valid_x_start = 0;
+    frame_buf->valid_x_end = ref_buf->y_crop_width;
+    frame_buf->valid_y_end = ref_buf->y_crop_height;
   }
 
   return cm->error.error_code;
@@ -289,6 +296,16 @@ int vp9_receive_compressed_data(VP9Decoder *pbi, size_t size,
     }
   }
 
+  if (pbi->key_frames_only && size != 0 &&
+      !vp9_frame_is_sync_point(pbi, source, source + size)) {
+    // The references are stale from here on, so inter frames can't be decoded
+    // again before a key or intra-only frame.
+    pbi->need_resync = 1;
+    pbi->ready_for_new_data = 1;
+    *psource = source + size;
+    return retcode;
+  }
+
   pbi->ready_for_new_data = 0;
 
   // Check if the previous frame was a frame without any references to it.
@@ -315,7 +332,7 @@ int vp9_receive_compressed_data(VP9Decoder *pbi, size_t size,
     frame_bufs[cm->new_fb_idx].frame_worker_owner = worker;
     // Reset decoding progress.
     pbi->cur_buf = &frame_bufs[cm->new_fb_idx];
-    pbi->cur_buf->row = -1;
+    vpx_atomic_store(&pbi->cur_buf->row, -1);
     pbi->cur_buf->col = -1;
     vp9_frameworker_unlock_stats(worker);
   } else {
@@ -376,8 +393,9 @@ int vp9_receive_compressed_data(VP9Decoder *pbi, size_t size,
 
   if (!cm->show_existing_frame) {
     cm->last_show_frame = cm->show_frame;
-    cm->prev_frame = cm->cur_frame;
-    if (cm->seg.enabled && !pbi->frame_parallel_decode)
+    // The motion vectors of a dropped frame were never decoded.
+    cm->prev_frame = pbi->dropped ? NULL : cm->cur_frame;
+    if (cm->seg.enabled && !pbi->frame_parallel_decode && !pbi->dropped)
       vp9_swap_current_and_last_seg_map(cm);
   }
 
@@ -421,7 +439,7 @@ int vp9_get_raw_frame(VP9Decoder *pbi, YV12_BUFFER_CONFIG *sd,
   pbi->ready_for_new_data = 1;
 
   /* no raw frame to show!!! */
-  if (!cm->show_frame) return ret;
+  if (!cm->show_frame || pbi->skip_recon || pbi->dropped) return ret;
 
   pbi->ready_for_new_data = 1;
 
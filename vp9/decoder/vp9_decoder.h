@@ -33,10 +33,21 @@ typedef struct TileBuffer {
   int col;  // only used with multi-threaded decoding
 } TileBuffer;
 
+// Coefficient probabilities with the Pareto tail of each model expanded, so
+// that every token is decoded from a single row of ENTROPY_NODES.
+typedef vpx_prob vp9_coeff_probs_full[REF_TYPES][COEF_BANDS][COEFF_CONTEXTS]
+                                     [ENTROPY_NODES];
+
 typedef struct TileWorkerData {
   const uint8_t *data_end;
   int buf_start, buf_end;  // pbi->tile_buffers to decode, inclusive
   vpx_reader bit_reader;
+  vp9_coeff_probs_full (*coef_probs)[PLANE_TYPES];  // pbi->coef_probs
+  int parse_only;     // Tile is not reconstructed, see reconstruct_tile().
+  int check_region;   // pbi->check_region
+  int preview_level;  // pbi->preview_level
+  // Area reconstructed the same as a full decode, before loop filtering.
+  int valid_x_start, valid_x_end, valid_y_end;
   FRAME_COUNTS counts;
   DECLARE_ALIGNED(16, MACROBLOCKD, xd);
   /* dqcoeff are shared by all the planes. So planes must be decoded serially */
@@ -44,6 +55,10 @@ typedef struct TileWorkerData {
   struct vpx_internal_error_info error_info;
 } TileWorkerData;
 
+// Receives the rows [y_start, y_end) of 'buf', which won't change anymore.
+typedef void (*vp9_rows_done_cb)(void *priv, const YV12_BUFFER_CONFIG *buf,
+                                 int y_start, int y_end);
+
 typedef struct VP9Decoder {
   DECLARE_ALIGNED(16, MACROBLOCKD, mb);
 
@@ -69,9 +84,39 @@ typedef struct VP9Decoder {
 
   VP9LfSync lf_row_sync;
 
+  // cm->fc->coef_probs of the frame being decoded, see vp9_coeff_probs_full.
+  vp9_coeff_probs_full coef_probs[TX_SIZES][PLANE_TYPES];
+
   vpx_decrypt_cb decrypt_cb;
   void *decrypt_state;
 
+  // Streaming input set with VP9D_SET_INPUT_WAIT. input_received counts the
+  // bytes from input_start known to have arrived.
+  vpx_input_wait_cb input_wait_cb;
+  void *input_wait_state;
+  const uint8_t *input_start;
+  size_t input_received;
+
+  // Called with the rows of the shown frame that are final as they finish
+  // decoding, see VPX_CODEC_CAP_PUT_SLICE. rows_done counts the rows already
+  // passed to it.
+  vp9_rows_done_cb rows_done_cb;
+  void *rows_done_priv;
+  int rows_done;
+
+  // Region of tiles requested with VP9_SET_DECODE_TILE_REGION, and the tiles
+  // it resolves to for the current frame.
+  vpx_tile_region_t tile_region;
+  int region_col_start, region_col_end, region_row_end;
+  int check_region;  // Reference areas need to be checked, see RefCntBuffer.
+
+  int preview_level;  // VP9_SET_FAST_PREVIEW
+  int skip_recon;     // Current frame is parsed but not reconstructed.
+
+  int drop_non_ref;     // VP9_SET_DROP_NON_REFERENCE
+  int key_frames_only;  // VP9_SET_KEY_FRAMES_ONLY
+  int dropped;          // Current frame was only read up to its headers.
+
   int max_threads;
   int inv_tile_order;
   int need_resync;   // wait for key/intra-only frame.
@@ -29,59 +29,28 @@
     if (counts) ++coef_counts[band][ctx][token]; \
   } while (0)
 
-static INLINE int read_bool(vpx_reader *r, int prob, BD_VALUE *value,
-                            int *count, unsigned int *range) {
-  const unsigned int split = (*range * prob + (256 - prob)) >> CHAR_BIT;
-  const BD_VALUE bigsplit = (BD_VALUE)split << (BD_VALUE_SIZE - CHAR_BIT);
-
-  if (*count < 0) {
-    r->value = *value;
-    r->count = *count;
-    vpx_reader_fill(r);
-    *value = r->value;
-    *count = r->count;
-  }
-
-  if (*value >= bigsplit) {
-    *range = *range - split;
-    *value = *value - bigsplit;
-    {
-      const int shift = vpx_norm[*range];
-      *range <<= shift;
-      *value <<= shift;
-      *count -= shift;
-    }
-    return 1;
-  }
-  *range = split;
-  {
-    const int shift = vpx_norm[*range];
-    *range <<= shift;
-    *value <<= shift;
-    *count -= shift;
-  }
-  return 0;
-}
-
 static INLINE int read_coeff(vpx_reader *r, const vpx_prob *probs, int n,
                              BD_VALUE *value, int *count, unsigned int *range) {
   int i, val = 0;
   for (i = 0; i < n; ++i)
-    val = (val << 1) | read_bool(r, probs[i], value, count, range);
+    val = (val << 1) |
+          vpx_read_bool_nobranch(r, probs[i], value, count, range);
   return val;
 }
 
-static int decode_coefs(const MACROBLOCKD *xd, PLANE_TYPE type,
+static int decode_coefs(TileWorkerData *twd, PLANE_TYPE type,
                         tran_low_t *dqcoeff, TX_SIZE tx_size, const int16_t *dq,
-                        int ctx, const int16_t *scan, const int16_t *nb,
-                        vpx_reader *r) {
+                        int ctx, const int16_t *scan, const int16_t *nb) {
+  const MACROBLOCKD *const xd = &twd->xd;
+  vpx_reader *const r = &twd->bit_reader;
   FRAME_COUNTS *counts = xd->counts;
   const int max_eob = 16 << (tx_size << 1);
-  const FRAME_CONTEXT *const fc = xd->fc;
   const int ref = is_inter_block(xd->mi[0]);
   int band, c = 0;
-  const vpx_prob(*coef_probs)[COEFF_CONTEXTS][UNCONSTRAINED_NODES] =
-      fc->coef_probs[tx_size][type][ref];
+  // The rows hold the model probabilities followed by the Pareto tail, so
+  // the tail of a TWO_TOKEN or larger does not need another table lookup.
+  const vpx_prob(*coef_probs)[COEFF_CONTEXTS][ENTROPY_NODES] =
+      twd->coef_probs[tx_size][type][ref];
   const vpx_prob *prob;
   unsigned int(*coef_counts)[COEFF_CONTEXTS][UNCONSTRAINED_NODES + 1];
   unsigned int(*eob_branch_count)[COEFF_CONTEXTS];
@@ -119,12 +88,12 @@ static int decode_coefs(const MACROBLOCKD *xd, PLANE_TYPE type,
     band = *band_translate++;
     prob = coef_probs[band][ctx];
     if (counts) ++eob_branch_count[band][ctx];
-    if (!read_bool(r, prob[EOB_CONTEXT_NODE], &value, &count, &range)) {
+    if (!vpx_read_bool(r, prob[EOB_CONTEXT_NODE], &value, &count, &range)) {
       INCREMENT_COUNT(EOB_MODEL_TOKEN);
       break;
     }
 
-    while (!read_bool(r, prob[ZERO_CONTEXT_NODE], &value, &count, &range)) {
+    while (!vpx_read_bool(r, prob[ZERO_CONTEXT_NODE], &value, &count, &range)) {
       INCREMENT_COUNT(ZERO_TOKEN);
       dqv = dq[1];
       token_cache[scan[c]] = 0;
@@ -140,21 +109,21 @@ static int decode_coefs(const MACROBLOCKD *xd, PLANE_TYPE type,
       prob = coef_probs[band][ctx];
     }
 
-    if (read_bool(r, prob[ONE_CONTEXT_NODE], &value, &count, &range)) {
-      const vpx_prob *p = vp9_pareto8_full[prob[PIVOT_NODE] - 1];
+    if (vpx_read_bool(r, prob[ONE_CONTEXT_NODE], &value, &count, &range)) {
+      const vpx_prob *p = prob + UNCONSTRAINED_NODES;
       INCREMENT_COUNT(TWO_TOKEN);
-      if (read_bool(r, p[0], &value, &count, &range)) {
-        if (read_bool(r, p[3], &value, &count, &range)) {
+      if (vpx_read_bool(r, p[0], &value, &count, &range)) {
+        if (vpx_read_bool(r, p[3], &value, &count, &range)) {
           token_cache[scan[c]] = 5;
-          if (read_bool(r, p[5], &value, &count, &range)) {
-            if (read_bool(r, p[7], &value, &count, &range)) {
+          if (vpx_read_bool(r, p[5], &value, &count, &range)) {
+            if (vpx_read_bool(r, p[7], &value, &count, &range)) {
               val = CAT6_MIN_VAL +
                     read_coeff(r, cat6_prob, cat6_bits, &value, &count, &range);
             } else {
               val = CAT5_MIN_VAL +
                     read_coeff(r, vp9_cat5_prob, 5, &value, &count, &range);
             }
-          } else if (read_bool(r, p[6], &value, &count, &range)) {
+          } else if (vpx_read_bool(r, p[6], &value, &count, &range)) {
             val = CAT4_MIN_VAL +
                   read_coeff(r, vp9_cat4_prob, 4, &value, &count, &range);
           } else {
@@ -163,7 +132,7 @@ static int decode_coefs(const MACROBLOCKD *xd, PLANE_TYPE type,
           }
         } else {
           token_cache[scan[c]] = 4;
-          if (read_bool(r, p[4], &value, &count, &range)) {
+          if (vpx_read_bool(r, p[4], &value, &count, &range)) {
             val = CAT2_MIN_VAL +
                   read_coeff(r, vp9_cat2_prob, 2, &value, &count, &range);
           } else {
@@ -178,9 +147,9 @@ static int decode_coefs(const MACROBLOCKD *xd, PLANE_TYPE type,
         v = (val * dqv) >> dq_shift;
 #endif
       } else {
-        if (read_bool(r, p[1], &value, &count, &range)) {
+        if (vpx_read_bool(r, p[1], &value, &count, &range)) {
           token_cache[scan[c]] = 3;
-          v = ((3 + read_bool(r, p[2], &value, &count, &range)) * dqv) >>
+          v = ((3 + vpx_read_bool(r, p[2], &value, &count, &range)) * dqv) >>
               dq_shift;
         } else {
           token_cache[scan[c]] = 2;
@@ -195,16 +164,19 @@ static int decode_coefs(const MACROBLOCKD *xd, PLANE_TYPE type,
 #if CONFIG_COEFFICIENT_RANGE_CHECKING
 #if CONFIG_VP9_HIGHBITDEPTH
     dqcoeff[scan[c]] = highbd_check_range(
-        read_bool(r, 128, &value, &count, &range) ? -v : v, xd->bd);
+        vpx_read_bool_nobranch(r, 128, &value, &count, &range) ? -v : v,
+        xd->bd);
 #else
     dqcoeff[scan[c]] =
-        check_range(read_bool(r, 128, &value, &count, &range) ? -v : v);
+        check_range(vpx_read_bool_nobranch(r, 128, &value, &count, &range)
+                        ? -v
+                        : v);
 #endif  // CONFIG_VP9_HIGHBITDEPTH
 #else
-    if (read_bool(r, 128, &value, &count, &range)) {
-      dqcoeff[scan[c]] = -v;
-    } else {
-      dqcoeff[scan[c]] = v;
+    {
+      // The sign is even odds, so apply it without a branch.
+      const int sign = -vpx_read_bool_nobranch(r, 128, &value, &count, &range);
+      dqcoeff[scan[c]] = (v ^ sign) - sign;
     }
 #endif  // CONFIG_COEFFICIENT_RANGE_CHECKING
     ++c;
@@ -233,7 +205,6 @@ static void get_ctx_shift(MACROBLOCKD *xd, int *ctx_shift_a, int *ctx_shift_l,
 int vp9_decode_block_tokens(TileWorkerData *twd, int plane,
                             const scan_order *sc, int x, int y, TX_SIZE tx_size,
                             int seg_id) {
-  vpx_reader *r = &twd->bit_reader;
   MACROBLOCKD *xd = &twd->xd;
   struct macroblockd_plane *const pd = &xd->plane[plane];
   const int16_t *const dequant = pd->seg_dequant[seg_id];
@@ -248,16 +219,16 @@ int vp9_decode_block_tokens(TileWorkerData *twd, int plane,
     case TX_4X4:
       ctx = a[0] != 0;
       ctx += l[0] != 0;
-      eob = decode_coefs(xd, get_plane_type(plane), pd->dqcoeff, tx_size,
-                         dequant, ctx, sc->scan, sc->neighbors, r);
+      eob = decode_coefs(twd, get_plane_type(plane), pd->dqcoeff, tx_size,
+                         dequant, ctx, sc->scan, sc->neighbors);
       a[0] = l[0] = (eob > 0);
       break;
     case TX_8X8:
       get_ctx_shift(xd, &ctx_shift_a, &ctx_shift_l, x, y, 1 << TX_8X8);
       ctx = !!*(const uint16_t *)a;
       ctx += !!*(const uint16_t *)l;
-      eob = decode_coefs(xd, get_plane_type(plane), pd->dqcoeff, tx_size,
-                         dequant, ctx, sc->scan, sc->neighbors, r);
+      eob = decode_coefs(twd, get_plane_type(plane), pd->dqcoeff, tx_size,
+                         dequant, ctx, sc->scan, sc->neighbors);
       *(uint16_t *)a = ((eob > 0) * 0x0101) >> ctx_shift_a;
       *(uint16_t *)l = ((eob > 0) * 0x0101) >> ctx_shift_l;
       break;
@@ -265,8 +236,8 @@ int vp9_decode_block_tokens(TileWorkerData *twd, int plane,
       get_ctx_shift(xd, &ctx_shift_a, &ctx_shift_l, x, y, 1 << TX_16X16);
       ctx = !!*(const uint32_t *)a;
       ctx += !!*(const uint32_t *)l;
-      eob = decode_coefs(xd, get_plane_type(plane), pd->dqcoeff, tx_size,
-                         dequant, ctx, sc->scan, sc->neighbors, r);
+      eob = decode_coefs(twd, get_plane_type(plane), pd->dqcoeff, tx_size,
+                         dequant, ctx, sc->scan, sc->neighbors);
       *(uint32_t *)a = ((eob > 0) * 0x01010101) >> ctx_shift_a;
       *(uint32_t *)l = ((eob > 0) * 0x01010101) >> ctx_shift_l;
       break;
@@ -277,8 +248,8 @@ int vp9_decode_block_tokens(TileWorkerData *twd, int plane,
       // boundaries.
       ctx = !!*(const uint64_t *)a;
       ctx += !!*(const uint64_t *)l;
-      eob = decode_coefs(xd, get_plane_type(plane), pd->dqcoeff, tx_size,
-                         dequant, ctx, sc->scan, sc->neighbors, r);
+      eob = decode_coefs(twd, get_plane_type(plane), pd->dqcoeff, tx_size,
+                         dequant, ctx, sc->scan, sc->neighbors);
       *(uint64_t *)a = ((eob > 0) * 0x0101010101010101ULL) >> ctx_shift_a;
       *(uint64_t *)l = ((eob > 0) * 0x0101010101010101ULL) >> ctx_shift_l;
       break;
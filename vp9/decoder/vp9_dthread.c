@@ -38,37 +38,21 @@ void vp9_frameworker_unlock_stats(VPxWorker *const worker) {
 void vp9_frameworker_signal_stats(VPxWorker *const worker) {
 #if CONFIG_MULTITHREAD
   FrameWorkerData *const worker_data = worker->data1;
-
-// TODO(hkuang): Fix the pthread_cond_broadcast in windows wrapper.
-#if defined(_WIN32) && !HAVE_PTHREAD_H
-  pthread_cond_signal(&worker_data->stats_cond);
-#else
   pthread_cond_broadcast(&worker_data->stats_cond);
-#endif
-
 #else
   (void)worker;
 #endif
 }
 
-// This macro prevents thread_sanitizer from reporting known concurrent writes.
-#if defined(__has_feature)
-#if __has_feature(thread_sanitizer)
-#define BUILDING_WITH_TSAN
-#endif
-#endif
-
-// TODO(hkuang): Remove worker parameter as it is only used in debug code.
-void vp9_frameworker_wait(VPxWorker *const worker, RefCntBuffer *const ref_buf,
-                          int row) {
+void vp9_frameworker_wait(RefCntBuffer *const ref_buf, int row,
+                          struct vpx_internal_error_info *error_info) {
 #if CONFIG_MULTITHREAD
   if (!ref_buf) return;
 
-#ifndef BUILDING_WITH_TSAN
-  // The following line of code will get harmless tsan error but it is the key
-  // to get best performance.
-  if (ref_buf->row >= row && ref_buf->buf.corrupted != 1) return;
-#endif
+  // Progress is published with an atomic store, so a reference that is far
+  // enough ahead costs a single load here.
+  if (vpx_atomic_load(&ref_buf->row) >= row && ref_buf->buf.corrupted != 1)
+    return;
 
   {
     // Find the worker thread that owns the reference frame. If the reference
@@ -79,54 +63,53 @@ void vp9_frameworker_wait(VPxWorker *const worker, RefCntBuffer *const ref_buf,
     const VP9Decoder *const pbi = ref_worker_data->pbi;
 
 #ifdef DEBUG_THREAD
-    {
-      FrameWorkerData *const worker_data = (FrameWorkerData *)worker->data1;
-      printf("%d %p worker is waiting for %d %p worker (%d)  ref %d \r\n",
-             worker_data->worker_id, worker, ref_worker_data->worker_id,
-             ref_buf->frame_worker_owner, row, ref_buf->row);
-    }
+    printf("waiting for %d %p worker (%d)  ref %d \r\n",
+           ref_worker_data->worker_id, ref_buf->frame_worker_owner, row,
+           vpx_atomic_load(&ref_buf->row));
 #endif
 
     vp9_frameworker_lock_stats(ref_worker);
-    while (ref_buf->row < row && pbi->cur_buf == ref_buf &&
+    // Register before checking the progress again so that the broadcaster
+    // either sees this waiter or this thread sees the new progress.
+    vpx_atomic_add(&ref_worker_data->num_row_waiters, 1);
+    while (vpx_atomic_load(&ref_buf->row) < row && pbi->cur_buf == ref_buf &&
            ref_buf->buf.corrupted != 1) {
       pthread_cond_wait(&ref_worker_data->stats_cond,
                         &ref_worker_data->stats_mutex);
     }
+    vpx_atomic_add(&ref_worker_data->num_row_waiters, -1);
 
     if (ref_buf->buf.corrupted == 1) {
-      FrameWorkerData *const worker_data = (FrameWorkerData *)worker->data1;
       vp9_frameworker_unlock_stats(ref_worker);
-      vpx_internal_error(&worker_data->pbi->common.error,
-                         VPX_CODEC_CORRUPT_FRAME,
-                         "Worker %p failed to decode frame", worker);
+      vpx_internal_error(error_info, VPX_CODEC_CORRUPT_FRAME,
+                         "Worker %p failed to decode frame", ref_worker);
     }
     vp9_frameworker_unlock_stats(ref_worker);
   }
 #else
-  (void)worker;
   (void)ref_buf;
   (void)row;
-  (void)ref_buf;
+  (void)error_info;
 #endif  // CONFIG_MULTITHREAD
 }
 
 void vp9_frameworker_broadcast(RefCntBuffer *const buf, int row) {
 #if CONFIG_MULTITHREAD
   VPxWorker *worker = buf->frame_worker_owner;
+  FrameWorkerData *const worker_data = (FrameWorkerData *)worker->data1;
 
 #ifdef DEBUG_THREAD
-  {
-    FrameWorkerData *const worker_data = (FrameWorkerData *)worker->data1;
-    printf("%d %p worker decode to (%d) \r\n", worker_data->worker_id,
-           buf->frame_worker_owner, row);
-  }
+  printf("%d %p worker decode to (%d) \r\n", worker_data->worker_id,
+         buf->frame_worker_owner, row);
 #endif
 
-  vp9_frameworker_lock_stats(worker);
-  buf->row = row;
-  vp9_frameworker_signal_stats(worker);
-  vp9_frameworker_unlock_stats(worker);
+  vpx_atomic_store(&buf->row, row);
+  // Only wake the other workers when one of them is blocked on this frame.
+  if (vpx_atomic_load(&worker_data->num_row_waiters) > 0) {
+    vp9_frameworker_lock_stats(worker);
+    vp9_frameworker_signal_stats(worker);
+    vp9_frameworker_unlock_stats(worker);
+  }
 #else
   (void)buf;
   (void)row;
@@ -12,6 +12,7 @@
 #define VP9_DECODER_VP9_DTHREAD_H_
 
 #include "./vpx_config.h"
+#include "vpx_ports/vpx_atomics.h"
 #include "vpx_util/vpx_thread.h"
 #include "vpx/internal/vpx_codec_internal.h"
 
@@ -43,6 +44,9 @@ typedef struct FrameWorkerData {
   pthread_mutex_t stats_mutex;
   pthread_cond_t stats_cond;
 #endif
+  // Number of other workers blocked in vp9_frameworker_wait() on the frame
+  // this worker is decoding. Progress is only broadcast when it is non-zero.
+  vpx_atomic_int num_row_waiters;
 
   int frame_context_ready;  // Current frame's context is ready to read.
   int frame_decoded;        // Finished decoding current frame.
@@ -52,12 +56,14 @@ void vp9_frameworker_lock_stats(VPxWorker *const worker);
 void vp9_frameworker_unlock_stats(VPxWorker *const worker);
 void vp9_frameworker_signal_stats(VPxWorker *const worker);
 
-// Wait until ref_buf has been decoded to row in real pixel unit.
+// Wait until ref_buf has been decoded to row in real pixel unit. A corrupt
+// reference is reported through error_info, which must belong to the calling
+// thread.
 // Note: worker may already finish decoding ref_buf and release it in order to
 // start decoding next frame. So need to check whether worker is still decoding
 // ref_buf.
-void vp9_frameworker_wait(VPxWorker *const worker, RefCntBuffer *const ref_buf,
-                          int row);
+void vp9_frameworker_wait(RefCntBuffer *const ref_buf, int row,
+                          struct vpx_internal_error_info *error_info);
 
 // FrameWorker broadcasts its decoding progress so other workers that are
 // waiting on it can resume decoding.
@@ -123,10 +123,35 @@ static void update_switchable_interp_probs(VP9_COMMON *cm, vpx_writer *w,
                      counts->switchable_interp[j], SWITCHABLE_FILTERS, w);
 }
 
+// The path of each token from TWO_TOKEN on through vp9_coef_con_tree: the
+// bits written, most significant first, and the nodes of the pareto model that
+// code them.
+static const struct {
+  uint8_t len;
+  uint8_t bits;
+  uint8_t nodes[4];
+} coef_con_paths[ENTROPY_TOKENS] = {
+  { 0, 0, { 0 } },            // ZERO_TOKEN
+  { 0, 0, { 0 } },            // ONE_TOKEN
+  { 2, 0, { 0, 1 } },         // TWO_TOKEN
+  { 3, 2, { 0, 1, 2 } },      // THREE_TOKEN
+  { 3, 3, { 0, 1, 2 } },      // FOUR_TOKEN
+  { 3, 4, { 0, 3, 4 } },      // CATEGORY1_TOKEN
+  { 3, 5, { 0, 3, 4 } },      // CATEGORY2_TOKEN
+  { 4, 12, { 0, 3, 5, 6 } },  // CATEGORY3_TOKEN
+  { 4, 13, { 0, 3, 5, 6 } },  // CATEGORY4_TOKEN
+  { 4, 14, { 0, 3, 5, 7 } },  // CATEGORY5_TOKEN
+  { 4, 15, { 0, 3, 5, 7 } },  // CATEGORY6_TOKEN
+  { 0, 0, { 0 } },            // EOB_TOKEN
+};
+
 static void pack_mb_tokens(vpx_writer *w, TOKENEXTRA **tp,
                            const TOKENEXTRA *const stop,
                            vpx_bit_depth_t bit_depth) {
   const TOKENEXTRA *p;
+  // The writer is kept in a local copy so that its state is not reloaded after
+  // every byte written to the buffer.
+  vpx_writer bc = *w;
   const vp9_extra_bit *const extra_bits =
 #if CONFIG_VP9_HIGHBITDEPTH
       (bit_depth == VPX_BITS_12)
@@ -139,15 +164,16 @@ static void pack_mb_tokens(vpx_writer *w, TOKENEXTRA **tp,
 
   for (p = *tp; p < stop && p->token != EOSB_TOKEN; ++p) {
     if (p->token == EOB_TOKEN) {
-      vpx_write(w, 0, p->context_tree[0]);
+      vpx_write(&bc, 0, p->context_tree[0]);
       continue;
     }
-    vpx_write(w, 1, p->context_tree[0]);
+    vpx_write(&bc, 1, p->context_tree[0]);
     while (p->token == ZERO_TOKEN) {
-      vpx_write(w, 0, p->context_tree[1]);
+      vpx_write(&bc, 0, p->context_tree[1]);
       ++p;
       if (p == stop || p->token == EOSB_TOKEN) {
         *tp = (TOKENEXTRA *)(uintptr_t)p + (p->token == EOSB_TOKEN);
+        *w = bc;
         return;
       }
     }
@@ -158,19 +184,22 @@ static void pack_mb_tokens(vpx_writer *w, TOKENEXTRA **tp,
       assert(t != ZERO_TOKEN);
       assert(t != EOB_TOKEN);
       assert(t != EOSB_TOKEN);
-      vpx_write(w, 1, context_tree[1]);
+      vpx_write(&bc, 1, context_tree[1]);
       if (t == ONE_TOKEN) {
-        vpx_write(w, 0, context_tree[2]);
-        vpx_write_bit(w, p->extra & 1);
+        vpx_write(&bc, 0, context_tree[2]);
+        vpx_write_bit(&bc, p->extra & 1);
       } else {  // t >= TWO_TOKEN && t < EOB_TOKEN
-        const struct vp9_token *const a = &vp9_coef_encodings[t];
-        const int v = a->value;
-        const int n = a->len;
+        const vpx_prob *const pareto =
+            vp9_pareto8_full[context_tree[PIVOT_NODE] - 1];
+        const uint8_t *const nodes = coef_con_paths[t].nodes;
+        const int bits = coef_con_paths[t].bits;
         const int e = p->extra;
-        vpx_write(w, 1, context_tree[2]);
-        vp9_write_tree(w, vp9_coef_con_tree,
-                       vp9_pareto8_full[context_tree[PIVOT_NODE] - 1], v,
-                       n - UNCONSTRAINED_NODES, 0);
+        int n = coef_con_paths[t].len;
+        int i = 0;
+        vpx_write(&bc, 1, context_tree[2]);
+        do {
+          vpx_write(&bc, (bits >> --n) & 1, pareto[nodes[i++]]);
+        } while (n);
         if (t >= CATEGORY1_TOKEN) {
           const vp9_extra_bit *const b = &extra_bits[t];
           const unsigned char *pb = b->prob;
@@ -178,14 +207,15 @@ static void pack_mb_tokens(vpx_writer *w, TOKENEXTRA **tp,
           int n = b->len;  // number of bits in v, assumed nonzero
           do {
             const int bb = (v >> --n) & 1;
-            vpx_write(w, bb, *pb++);
+            vpx_write(&bc, bb, *pb++);
           } while (n);
         }
-        vpx_write_bit(w, e & 1);
+        vpx_write_bit(&bc, e & 1);
       }
     }
   }
   *tp = (TOKENEXTRA *)(uintptr_t)p + (p->token == EOSB_TOKEN);
+  *w = bc;
 }
 
 static void write_segment_id(vpx_writer *w, const struct segmentation *seg,
@@ -479,33 +509,41 @@ static void write_modes_sb(
     update_partition_context(xd, mi_row, mi_col, subsize, bsize);
 }
 
+static void write_modes_sb_row(
+    VP9_COMP *cpi, MACROBLOCKD *const xd, const TileInfo *const tile,
+    vpx_writer *w, int tile_row, int tile_col, int mi_row,
+    unsigned int *const max_mv_magnitude,
+    int interp_filter_selected[MAX_REF_FRAMES][SWITCHABLE]) {
+  const int tile_sb_row = mi_cols_aligned_to_sb(mi_row - tile->mi_row_start) >>
+                          MI_BLOCK_SIZE_LOG2;
+  TOKENEXTRA *tok = cpi->tplist[tile_row][tile_col][tile_sb_row].start;
+  const TOKENEXTRA *const tok_end =
+      tok + cpi->tplist[tile_row][tile_col][tile_sb_row].count;
+  int mi_col;
+
+  vp9_zero(xd->left_seg_context);
+  for (mi_col = tile->mi_col_start; mi_col < tile->mi_col_end;
+       mi_col += MI_BLOCK_SIZE)
+    write_modes_sb(cpi, xd, tile, w, &tok, tok_end, mi_row, mi_col,
+                   BLOCK_64X64, max_mv_magnitude, interp_filter_selected);
+
+  assert(tok == cpi->tplist[tile_row][tile_col][tile_sb_row].stop);
+}
+
 static void write_modes(
     VP9_COMP *cpi, MACROBLOCKD *const xd, const TileInfo *const tile,
     vpx_writer *w, int tile_row, int tile_col,
     unsigned int *const max_mv_magnitude,
     int interp_filter_selected[MAX_REF_FRAMES][SWITCHABLE]) {
   const VP9_COMMON *const cm = &cpi->common;
-  int mi_row, mi_col, tile_sb_row;
-  TOKENEXTRA *tok = NULL;
-  TOKENEXTRA *tok_end = NULL;
+  int mi_row;
 
   set_partition_probs(cm, xd);
 
   for (mi_row = tile->mi_row_start; mi_row < tile->mi_row_end;
-       mi_row += MI_BLOCK_SIZE) {
-    tile_sb_row = mi_cols_aligned_to_sb(mi_row - tile->mi_row_start) >>
-                  MI_BLOCK_SIZE_LOG2;
-    tok = cpi->tplist[tile_row][tile_col][tile_sb_row].start;
-    tok_end = tok + cpi->tplist[tile_row][tile_col][tile_sb_row].count;
-
-    vp9_zero(xd->left_seg_context);
-    for (mi_col = tile->mi_col_start; mi_col < tile->mi_col_end;
-         mi_col += MI_BLOCK_SIZE)
-      write_modes_sb(cpi, xd, tile, w, &tok, tok_end, mi_row, mi_col,
-                     BLOCK_64X64, max_mv_magnitude, interp_filter_selected);
-
-    assert(tok == cpi->tplist[tile_row][tile_col][tile_sb_row].stop);
-  }
+       mi_row += MI_BLOCK_SIZE)
+    write_modes_sb_row(cpi, xd, tile, w, tile_row, tile_col, mi_row,
+                       max_mv_magnitude, interp_filter_selected);
 }
 
 static void build_tree_distribution(VP9_COMP *cpi, TX_SIZE tx_size,
@@ -1082,6 +1120,33 @@ static size_t encode_tiles(VP9_COMP *cpi, uint8_t *data_ptr) {
   return total_size;
 }
 
+static size_t write_packed_tiles(VP9_COMP *cpi, uint8_t *data_ptr) {
+  VP9_COMMON *const cm = &cpi->common;
+  const int num_tiles = 1 << (cm->log2_tile_cols + cm->log2_tile_rows);
+  size_t total_size = 0;
+  int i, k;
+
+  for (i = 0; i < num_tiles; ++i) {
+    const TileDataEnc *const this_tile = &cpi->tile_data[i];
+    const uint32_t tile_size = this_tile->pack_bc.pos;
+
+    cpi->max_mv_magnitude =
+        VPXMAX(cpi->max_mv_magnitude, this_tile->max_mv_magnitude);
+    for (k = 0; k < SWITCHABLE; ++k)
+      cpi->interp_filter_selected[0][k] +=
+          this_tile->interp_filter_selected[0][k];
+
+    // Prefix the size of the tile on all but the last.
+    if (i < num_tiles - 1) {
+      mem_put_be32(data_ptr + total_size, tile_size);
+      total_size += 4;
+    }
+    memcpy(data_ptr + total_size, this_tile->pack_bc.buffer, tile_size);
+    total_size += tile_size;
+  }
+  return total_size;
+}
+
 static void write_render_size(const VP9_COMMON *cm,
                               struct vpx_write_bit_buffer *wb) {
   const int scaling_active =
@@ -1236,7 +1301,9 @@ static void write_uncompressed_header(VP9_COMP *cpi,
 
       vpx_wb_write_bit(wb, cm->allow_high_precision_mv);
 
-      fix_interp_filter(cm, cpi->td.counts);
+      // Packed superblock rows were coded with the filter picked before
+      // encoding.
+      if (!cpi->pack_sb_rows) fix_interp_filter(cm, cpi->td.counts);
       write_interp_filter(cm->interp_filter, wb);
     }
   }
@@ -1332,6 +1399,75 @@ static size_t write_compressed_header(VP9_COMP *cpi, uint8_t *data) {
   return header_bc.pos;
 }
 
+// Bytes of tile_pack_buf set aside for each 8x8 block: the size of the
+// uncompressed block, as for the buffer the frame is finally written to.
+static size_t pack_bytes_per_mi(const VP9_COMMON *cm) {
+  const size_t bytes = 64 + 2 * (64 >> (cm->subsampling_x + cm->subsampling_y));
+#if CONFIG_VP9_HIGHBITDEPTH
+  if (cm->use_highbitdepth) return 2 * bytes;
+#endif
+  return bytes;
+}
+
+void vp9_start_sb_row_packing(VP9_COMP *cpi) {
+  VP9_COMMON *const cm = &cpi->common;
+  const size_t pack_buf_size =
+      (size_t)cm->mi_rows * cm->mi_cols * pack_bytes_per_mi(cm);
+
+  if (cpi->packed_header == NULL)
+    CHECK_MEM_ERROR(cm, cpi->packed_header, vpx_malloc(1 << 16));
+  if (pack_buf_size > cpi->tile_pack_buf_size) {
+    vpx_free(cpi->tile_pack_buf);
+    cpi->tile_pack_buf_size = 0;
+    CHECK_MEM_ERROR(cm, cpi->tile_pack_buf, vpx_malloc(pack_buf_size));
+    cpi->tile_pack_buf_size = pack_buf_size;
+  }
+
+  // The counts of this frame are not known until it is encoded, so the
+  // probability updates are chosen with the counts of the last frame coded.
+  // The header is applied to the frame context the decoder starts from,
+  // which a re-encode of the frame may have updated already.
+  *cm->fc = cm->frame_contexts[cm->frame_context_idx];
+  cpi->packed_header_size = write_compressed_header(cpi, cpi->packed_header);
+}
+
+void vp9_pack_sb_row(VP9_COMP *cpi, ThreadData *td, int tile_row,
+                     int tile_col, int mi_row) {
+  VP9_COMMON *const cm = &cpi->common;
+  const int tile_cols = 1 << cm->log2_tile_cols;
+  TileDataEnc *const this_tile =
+      &cpi->tile_data[tile_row * tile_cols + tile_col];
+  const TileInfo *const tile = &this_tile->tile_info;
+  MACROBLOCKD xd = td->mb.e_mbd;
+
+  if (mi_row == tile->mi_row_start) {
+    // Tiles are given their share of tile_pack_buf in raster order.
+    const size_t offset =
+        ((size_t)tile->mi_row_start * cm->mi_cols +
+         (size_t)(tile->mi_row_end - tile->mi_row_start) * tile->mi_col_start) *
+        pack_bytes_per_mi(cm);
+
+    // The partition context carries over from the tile above.
+    if (tile_row == 0)
+      memset(cpi->pack_seg_context + tile->mi_col_start, 0,
+             sizeof(*cpi->pack_seg_context) *
+                 mi_cols_aligned_to_sb(tile->mi_col_end - tile->mi_col_start));
+    this_tile->max_mv_magnitude = 0;
+    vp9_zero(this_tile->interp_filter_selected);
+    vpx_start_encode(&this_tile->pack_bc, cpi->tile_pack_buf + offset);
+  }
+
+  // The encoder is still using cm->above_seg_context for the rows below.
+  xd.above_seg_context = cpi->pack_seg_context;
+  set_partition_probs(cm, &xd);
+  write_modes_sb_row(cpi, &xd, tile, &this_tile->pack_bc, tile_row, tile_col,
+                     mi_row, &this_tile->max_mv_magnitude,
+                     this_tile->interp_filter_selected);
+
+  if (mi_row + MI_BLOCK_SIZE >= tile->mi_row_end)
+    vpx_stop_encode(&this_tile->pack_bc);
+}
+
 void vp9_pack_bitstream(VP9_COMP *cpi, uint8_t *dest, size_t *size) {
   uint8_t *data = dest;
   size_t first_part_size, uncompressed_hdr_size;
@@ -1347,12 +1483,20 @@ void vp9_pack_bitstream(VP9_COMP *cpi, uint8_t *dest, size_t *size) {
 
   vpx_clear_system_state();
 
-  first_part_size = write_compressed_header(cpi, data);
+  if (cpi->pack_sb_rows) {
+    first_part_size = cpi->packed_header_size;
+    memcpy(data, cpi->packed_header, first_part_size);
+  } else {
+    first_part_size = write_compressed_header(cpi, data);
+  }
   data += first_part_size;
   // TODO(jbb): Figure out what to do if first_part_size > 16 bits.
   vpx_wb_write_literal(&saved_wb, (int)first_part_size, 16);
 
-  data += encode_tiles(cpi, data);
+  if (cpi->pack_sb_rows)
+    data += write_packed_tiles(cpi, data);
+  else
+    data += encode_tiles(cpi, data);
 
   *size = data - dest;
 }
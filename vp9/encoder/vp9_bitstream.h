@@ -35,6 +35,14 @@ int vp9_get_refresh_mask(VP9_COMP *cpi);
 
 void vp9_bitstream_encode_tiles_buffer_dealloc(VP9_COMP *const cpi);
 
+// Writes the compressed header of a frame whose superblock rows are packed as
+// they are encoded, before the frame is encoded.
+void vp9_start_sb_row_packing(VP9_COMP *cpi);
+
+// Packs a superblock row of a tile once it is encoded.
+void vp9_pack_sb_row(VP9_COMP *cpi, ThreadData *td, int tile_row,
+                     int tile_col, int mi_row);
+
 void vp9_pack_bitstream(VP9_COMP *cpi, uint8_t *dest, size_t *size);
 
 static INLINE int vp9_preserve_existing_gf(VP9_COMP *cpi) {
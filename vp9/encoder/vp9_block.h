@@ -165,6 +165,9 @@ struct macroblock {
   // Used to store sub partition's choices.
   MV pred_mv[MAX_REF_FRAMES];
 
+  // Co-located motion of earlier frames, see vp9_mv_pred().
+  MV temporal_mv[MAX_REF_FRAMES];
+
   // Strong color activity detection. Used in RTC coding mode to enhance
   // the visual quality at the boundary of moving color objects.
   uint8_t color_sensitivity[2];
@@ -173,6 +176,11 @@ struct macroblock {
 
   uint8_t skip_low_source_sad;
 
+  // Superblocks coded by the thread in the frame, and whether the current
+  // one is coded with faster searches to catch up with the time budget.
+  int sb_count;
+  uint8_t sb_late;
+
   uint8_t last_sb_high_content;
 
   // Used to save the status of whether a block has a low variance in
@@ -37,6 +37,7 @@
 #include "vp9/encoder/vp9_aq_complexity.h"
 #include "vp9/encoder/vp9_aq_cyclicrefresh.h"
 #include "vp9/encoder/vp9_aq_variance.h"
+#include "vp9/encoder/vp9_bitstream.h"
 #include "vp9/encoder/vp9_encodeframe.h"
 #include "vp9/encoder/vp9_encodemb.h"
 #include "vp9/encoder/vp9_encodemv.h"
@@ -79,6 +80,38 @@ static const double classifiers[24] = {
   0.050028, 0.150873, 0.061119, 0.109318, 0.127255, 0.625211
 };
 
+// Machine learning-based partition pruning models: one linear model per block
+// size over the features of get_partition_features(), followed by a bias. A
+// positive score prunes the partition types.
+#define PARTITION_FEATURES 14
+
+// Stops splitting 16x16, 32x32 and 64x64 blocks after PARTITION_NONE.
+static const float split_prune_weights[3][PARTITION_FEATURES + 1] = {
+  { -1.393112f, -0.761906f, -0.111906f, 0.183025f, -0.301366f, -0.081681f,
+    0.049239f, -0.027809f, -0.668122f, 0.101215f, -0.018699f, 0.369113f,
+    0.000000f, 0.000000f, 11.760456f },
+  { -1.218723f, -0.830515f, -0.113894f, 1.161819f, 0.034220f, -0.012601f,
+    -0.166879f, 0.164859f, -0.518725f, 0.103831f, -1.268632f, 0.749769f,
+    0.000000f, 0.000000f, 7.793000f },
+  { -0.931892f, -0.596448f, 0.105754f, 1.644568f, -0.088479f, -0.177650f,
+    -0.381812f, -1.342829f, 0.722441f, 0.104460f, -3.545437f, -0.876534f,
+    0.000000f, 0.000000f, 0.954665f },
+};
+
+// Skips the rectangular partitions of 8x8, 16x16 and 32x32 blocks after
+// PARTITION_SPLIT.
+static const float rect_prune_weights[3][PARTITION_FEATURES + 1] = {
+  { -0.177719f, -0.040706f, -0.091708f, -0.218688f, 0.033763f, -0.149168f,
+    -0.267359f, -0.200954f, 0.132743f, -0.041427f, 0.156197f, -1.147288f,
+    1.619977f, 0.000000f, 0.090166f },
+  { -0.008381f, 0.090198f, 0.333035f, -1.068083f, 0.299545f, 0.095048f,
+    0.173428f, 1.919469f, 0.110720f, 0.034584f, 2.090585f, 0.949082f, 1.586680f,
+    0.953054f, -6.902063f },
+  { 0.583098f, 0.097305f, 0.100715f, 1.132656f, 0.097776f, -0.294636f,
+    0.359011f, 0.000000f, -0.025774f, -0.039268f, -1.109853f, 1.274716f,
+    -1.389962f, 0.630831f, -3.342314f },
+};
+
 // This is used as a reference when computing the source variance for the
 //  purpose of activity masking.
 // Eventually this should be replaced by custom no-reference routines,
@@ -1968,6 +2001,57 @@ static void set_fixed_partitioning(VP9_COMP *cpi, const TileInfo *const tile,
   }
 }
 
+// Sets the partitioning of the block from the block sizes of the mode hints,
+// like copy_partitioning_helper(). Blocks smaller than 8x8 are coded as 8x8
+// blocks, and blocks crossing the frame edge are split.
+static void set_mode_hint_partitioning(VP9_COMP *cpi, MACROBLOCK *const x,
+                                       MACROBLOCKD *const xd, BLOCK_SIZE bsize,
+                                       int mi_row, int mi_col) {
+  VP9_COMMON *const cm = &cpi->common;
+  const int bsl = b_width_log2_lookup[bsize];
+  const int bs = (1 << bsl) / 4;
+  BLOCK_SIZE subsize;
+  PARTITION_TYPE partition;
+
+  if (mi_row >= cm->mi_rows || mi_col >= cm->mi_cols) return;
+
+  if (mi_row + bs >= cm->mi_rows || mi_col + bs >= cm->mi_cols) {
+    partition = bsize > BLOCK_8X8 ? PARTITION_SPLIT : PARTITION_NONE;
+  } else {
+    const BLOCK_SIZE hint_size =
+        cpi->mode_hints.hints[mi_row * cm->mi_cols + mi_col].sb_type;
+    partition = partition_lookup[bsl][hint_size];
+    if (partition == PARTITION_INVALID) partition = PARTITION_NONE;
+  }
+  subsize = get_subsize(bsize, partition);
+
+  if (subsize < BLOCK_8X8) {
+    set_block_size(cpi, x, xd, mi_row, mi_col, bsize);
+  } else {
+    switch (partition) {
+      case PARTITION_NONE:
+        set_block_size(cpi, x, xd, mi_row, mi_col, bsize);
+        break;
+      case PARTITION_HORZ:
+        set_block_size(cpi, x, xd, mi_row, mi_col, subsize);
+        set_block_size(cpi, x, xd, mi_row + bs, mi_col, subsize);
+        break;
+      case PARTITION_VERT:
+        set_block_size(cpi, x, xd, mi_row, mi_col, subsize);
+        set_block_size(cpi, x, xd, mi_row, mi_col + bs, subsize);
+        break;
+      case PARTITION_SPLIT:
+        set_mode_hint_partitioning(cpi, x, xd, subsize, mi_row, mi_col);
+        set_mode_hint_partitioning(cpi, x, xd, subsize, mi_row + bs, mi_col);
+        set_mode_hint_partitioning(cpi, x, xd, subsize, mi_row, mi_col + bs);
+        set_mode_hint_partitioning(cpi, x, xd, subsize, mi_row + bs,
+                                   mi_col + bs);
+        break;
+      default: assert(0);
+    }
+  }
+}
+
 static const struct {
   int row;
   int col;
@@ -2614,6 +2698,45 @@ static void rd_auto_partition_range(VP9_COMP *cpi, const TileInfo *const tile,
   *max_block_size = max_size;
 }
 
+// Sets the partition search range of the SB64 around the block sizes of the
+// mode hints it covers.
+static void mode_hint_partition_range(VP9_COMP *cpi, const TileInfo *const tile,
+                                      int mi_row, int mi_col,
+                                      BLOCK_SIZE *min_block_size,
+                                      BLOCK_SIZE *max_block_size) {
+  const VP9_COMMON *const cm = &cpi->common;
+  const MODE_HINT *const hints =
+      &cpi->mode_hints.hints[mi_row * cm->mi_cols + mi_col];
+  const int row8x8_remaining = tile->mi_row_end - mi_row;
+  const int col8x8_remaining = tile->mi_col_end - mi_col;
+  const int rows = VPXMIN(row8x8_remaining, MI_BLOCK_SIZE);
+  const int cols = VPXMIN(col8x8_remaining, MI_BLOCK_SIZE);
+  BLOCK_SIZE min_size = BLOCK_64X64;
+  BLOCK_SIZE max_size = BLOCK_4X4;
+  int r, c, bh, bw;
+
+  for (r = 0; r < rows; ++r) {
+    for (c = 0; c < cols; ++c) {
+      const BLOCK_SIZE sb_type = hints[r * cm->mi_cols + c].sb_type;
+      min_size = VPXMIN(min_size, sb_type);
+      max_size = VPXMAX(max_size, sb_type);
+    }
+  }
+
+  // Transcoding to a lower rate tends to merge blocks, so allow one size
+  // larger than the hints.
+  max_size = find_partition_size(max_partition_size[max_size],
+                                 row8x8_remaining, col8x8_remaining, &bh, &bw);
+  min_size = VPXMIN(min_size, max_size);
+  if (cpi->sf.use_square_partition_only &&
+      next_square_size[max_size] < min_size) {
+    min_size = next_square_size[max_size];
+  }
+
+  *min_block_size = min_size;
+  *max_block_size = max_size;
+}
+
 // TODO(jingning) refactor functions setting partition search range
 static void set_partition_range(VP9_COMMON *cm, MACROBLOCKD *xd, int mi_row,
                                 int mi_col, BLOCK_SIZE bsize,
@@ -2792,9 +2915,63 @@ static double compute_score(VP9_COMMON *const cm, MACROBLOCKD *const xd,
   return score;
 }
 
+static int get_context_partitioning(const MODE_INFO *mi, BLOCK_SIZE bsize) {
+  if (mi == NULL) return 0;
+  if (mi->sb_type < bsize) return 2;
+  return mi->sb_type == bsize;
+}
+
+// Computes the features of the partition pruning models from the
+// PARTITION_NONE search of the block: its rate and distortion per pixel, the
+// source variance, the q index, the partitioning of the above, left and
+// co-located last frame blocks, and the mode picked. The last two features
+// describe the PARTITION_SPLIT search and are filled in once it is done.
+static void get_partition_features(const VP9_COMMON *cm, const MACROBLOCK *x,
+                                   const PICK_MODE_CONTEXT *ctx,
+                                   const RD_COST *none_rdc, int mi_row,
+                                   int mi_col, BLOCK_SIZE bsize,
+                                   float *features) {
+  const MACROBLOCKD *const xd = &x->e_mbd;
+  const double num_pels = 1 << num_pels_log2_lookup[bsize];
+  const MODE_INFO *last_mi = NULL;
+
+  if (cm->prev_mi_grid_visible != NULL)
+    last_mi = cm->prev_mi_grid_visible[mi_row * cm->mi_stride + mi_col];
+
+  features[0] = (float)log(1.0 + none_rdc->rate / num_pels);
+  features[1] = (float)log(1.0 + none_rdc->dist / num_pels);
+  features[2] = (float)log(1.0 + x->source_variance);
+  features[3] = cm->base_qindex / 255.0f;
+  features[4] = (float)get_context_partitioning(xd->above_mi, bsize);
+  features[5] = (float)get_context_partitioning(xd->left_mi, bsize);
+  features[6] = (float)get_context_partitioning(last_mi, bsize);
+  features[7] = (float)ctx->skippable;
+  features[8] = (float)(ctx->mic.ref_frame[0] > INTRA_FRAME);
+  features[9] = (float)log(1.0 + abs(ctx->mic.mv[0].as_mv.row) +
+                           abs(ctx->mic.mv[0].as_mv.col));
+  features[10] = (float)log(1.0 + ctx->sum_y_eobs / num_pels);
+  features[11] = (float)frame_is_intra_only(cm);
+  features[12] = 0.0f;
+  features[13] = 0.0f;
+}
+
+static int ml_prune_partition(const float *weights, const float *features) {
+  float score = weights[PARTITION_FEATURES];
+  int i;
+  for (i = 0; i < PARTITION_FEATURES; ++i) score += weights[i] * features[i];
+  return score > 0.0f;
+}
+
 // TODO(jingning,jimbankoski,rbultje): properly skip partition types that are
 // unlikely to be selected depending on previous rate-distortion optimization
 // results, for encoding speed-up.
+// Note: the NONE/SPLIT/HORZ/VERT candidates below are not independent and are
+// evaluated in a fixed order on purpose. Each candidate writes its mode info
+// into cm->mi, its reconstruction into the shared frame buffer (used as the
+// intra predictor of the following sub-blocks) and adapts
+// tile_data->thresh_freq_fact, and the result of each candidate bounds the rd
+// budget and pruning of the next ones. Parallelism within a tile is provided
+// by the superblock-row wavefront instead (see vp9_encode_tiles_row_mt()).
 static void rd_pick_partition(VP9_COMP *cpi, ThreadData *td,
                               TileDataEnc *tile_data, TOKENEXTRA **tp,
                               int mi_row, int mi_col, BLOCK_SIZE bsize,
@@ -2816,6 +2993,8 @@ static void rd_pick_partition(VP9_COMP *cpi, ThreadData *td,
   int do_split = bsize >= BLOCK_8X8;
   int do_rect = 1;
   INTERP_FILTER pred_interp_filter;
+  float features[PARTITION_FEATURES];
+  int64_t none_rdcost = 0;
 
   // Override skipping rectangular partition operations for edge blocks
   const int force_horz_split = (mi_row + mi_step >= cm->mi_rows);
@@ -2873,7 +3052,7 @@ static void rd_pick_partition(VP9_COMP *cpi, ThreadData *td,
 
   // Determine partition types in search according to the speed features.
   // The threshold set here has to be of square block size.
-  if (cpi->sf.auto_min_max_partition_size) {
+  if (cpi->sf.auto_min_max_partition_size || cpi->mode_hints.enabled) {
     partition_none_allowed &= (bsize <= max_size && bsize >= min_size);
     partition_horz_allowed &=
         ((bsize <= max_size && bsize > min_size) || force_horz_split);
@@ -3045,6 +3224,19 @@ static void rd_pick_partition(VP9_COMP *cpi, ThreadData *td,
         }
 #endif
       }
+
+      if (cpi->sf.ml_prune_partition && !x->e_mbd.lossless) {
+        none_rdcost = this_rdc.rdcost;
+        get_partition_features(cm, x, ctx, &this_rdc, mi_row, mi_col, bsize,
+                               features);
+        if (do_split && bsize >= BLOCK_16X16 &&
+            ml_prune_partition(
+                split_prune_weights[b_width_log2_lookup[bsize] - 2],
+                features)) {
+          do_split = 0;
+          do_rect = 0;
+        }
+      }
     }
     restore_context(x, mi_row, mi_col, a, l, sa, sl, bsize);
   }
@@ -3123,9 +3315,34 @@ static void rd_pick_partition(VP9_COMP *cpi, ThreadData *td,
            (best_rdc.dist < dist_breakout_thr)))
         do_rect &= !partition_none_allowed;
     }
+
+    if (none_rdcost > 0) {
+      // Relative rd cost of the split and number of sub-blocks that picked a
+      // rectangular partition.
+      features[12] = 2.0f;
+      if (i == 4 && sum_rdc.rdcost < INT64_MAX)
+        features[12] =
+            (float)VPXMIN((double)sum_rdc.rdcost / none_rdcost, 2.0);
+      if (bsize > BLOCK_8X8) {
+        for (i = 0; i < 4; ++i) {
+          const PARTITION_TYPE partitioning = pc_tree->split[i]->partitioning;
+          features[13] += partitioning == PARTITION_HORZ ||
+                          partitioning == PARTITION_VERT;
+        }
+      }
+    }
     restore_context(x, mi_row, mi_col, a, l, sa, sl, bsize);
+  } else if (none_rdcost > 0) {
+    features[12] = 2.0f;
   }
 
+  if (none_rdcost > 0 && do_rect && bsize <= BLOCK_32X32 &&
+      !force_horz_split && !force_vert_split &&
+      (partition_horz_allowed || partition_vert_allowed) &&
+      ml_prune_partition(rect_prune_weights[b_width_log2_lookup[bsize] - 1],
+                         features))
+    do_rect = 0;
+
   // PARTITION_HORZ
   if (partition_horz_allowed &&
       (do_rect || vp9_active_h_edge(cpi, mi_row, mi_step))) {
@@ -3241,6 +3458,50 @@ static void rd_pick_partition(VP9_COMP *cpi, ThreadData *td,
   }
 }
 
+// Splits what is left of the frame encode time target, less a quarter kept
+// for the loop filter and the packing of the frame, between the superblocks
+// coded by each thread.
+static void init_sb_time_budget(VP9_COMP *cpi) {
+  VP9_COMMON *const cm = &cpi->common;
+  SpeedControl *const sc = &cpi->speed_control;
+  MACROBLOCK *const x = &cpi->td.mb;
+  const int sb_cols = mi_cols_aligned_to_sb(cm->mi_cols) >> MI_BLOCK_SIZE_LOG2;
+  const int sb_rows = mi_cols_aligned_to_sb(cm->mi_rows) >> MI_BLOCK_SIZE_LOG2;
+  struct vpx_usec_timer timer;
+  int num_threads;
+
+  x->sb_count = 0;
+  x->sb_late = 0;
+  sc->sb_budget = 0;
+  if (!use_speed_control(cpi)) return;
+
+  if (cpi->row_mt)
+    num_threads = VPXMAX(cpi->oxcf.max_threads, 1);
+  else
+    num_threads = clamp(cpi->oxcf.max_threads, 1, 1 << cm->log2_tile_cols);
+
+  timer = sc->frame_timer;
+  vpx_usec_timer_mark(&timer);
+  sc->sb_start_time = vpx_usec_timer_elapsed(&timer);
+  sc->sb_budget = VPXMAX(sc->target_time * 3 / 4 - sc->sb_start_time, 1);
+  sc->sbs_per_thread = (sb_rows * sb_cols + num_threads - 1) / num_threads;
+}
+
+// Checks whether the thread is more than a superblock behind its share of
+// the time budget when it starts the next superblock.
+static void update_sb_time_budget(const VP9_COMP *cpi, ThreadData *td) {
+  const SpeedControl *const sc = &cpi->speed_control;
+  MACROBLOCK *const x = &td->mb;
+  struct vpx_usec_timer timer = sc->frame_timer;
+
+  vpx_usec_timer_mark(&timer);
+  ++x->sb_count;
+  x->sb_late = (vpx_usec_timer_elapsed(&timer) - sc->sb_start_time) *
+                   sc->sbs_per_thread >
+               sc->sb_budget * x->sb_count;
+  td->rd_counts.late_sbs += x->sb_late;
+}
+
 static void encode_rd_sb_row(VP9_COMP *cpi, ThreadData *td,
                              TileDataEnc *tile_data, int mi_row,
                              TOKENEXTRA **tp) {
@@ -3291,6 +3552,8 @@ static void encode_rd_sb_row(VP9_COMP *cpi, ThreadData *td,
     vp9_zero(x->pred_mv);
     td->pc_root->index = 0;
 
+    if (cpi->speed_control.sb_budget > 0) update_sb_time_budget(cpi, td);
+
     if (seg->enabled) {
       const uint8_t *const map =
           seg->update_map ? cpi->segmentation_map : cm->last_frame_seg_map;
@@ -3299,14 +3562,18 @@ static void encode_rd_sb_row(VP9_COMP *cpi, ThreadData *td,
     }
 
     x->source_variance = UINT_MAX;
-    if (sf->partition_search_type == FIXED_PARTITION || seg_skip) {
+    if (sf->partition_search_type == FIXED_PARTITION || seg_skip ||
+        (x->sb_late && frame_is_intra_only(cm))) {
       const BLOCK_SIZE bsize =
-          seg_skip ? BLOCK_64X64 : sf->always_this_block_size;
+          seg_skip ? BLOCK_64X64 : x->sb_late ? BLOCK_16X16
+                                              : sf->always_this_block_size;
       set_offsets(cpi, tile_info, x, mi_row, mi_col, BLOCK_64X64);
       set_fixed_partitioning(cpi, tile_info, mi, mi_row, mi_col, bsize);
       rd_use_partition(cpi, td, tile_data, mi, tp, mi_row, mi_col, BLOCK_64X64,
                        &dummy_rate, &dummy_dist, 1, td->pc_root);
-    } else if (cpi->partition_search_skippable_frame) {
+    } else if (cpi->partition_search_skippable_frame || x->sb_late) {
+      // Late superblocks are coded like those of frames that skip the
+      // partition search.
       BLOCK_SIZE bsize;
       set_offsets(cpi, tile_info, x, mi_row, mi_col, BLOCK_64X64);
       bsize = get_rd_var_based_fixed_partition(cpi, x, mi_row, mi_col);
@@ -3320,7 +3587,12 @@ static void encode_rd_sb_row(VP9_COMP *cpi, ThreadData *td,
                        &dummy_rate, &dummy_dist, 1, td->pc_root);
     } else {
       // If required set upper and lower partition size limits
-      if (sf->auto_min_max_partition_size) {
+      if (cpi->mode_hints.enabled) {
+        set_offsets(cpi, tile_info, x, mi_row, mi_col, BLOCK_64X64);
+        mode_hint_partition_range(cpi, tile_info, mi_row, mi_col,
+                                  &x->min_partition_size,
+                                  &x->max_partition_size);
+      } else if (sf->auto_min_max_partition_size) {
         set_offsets(cpi, tile_info, x, mi_row, mi_col, BLOCK_64X64);
         rd_auto_partition_range(cpi, tile_info, xd, mi_row, mi_col,
                                 &x->min_partition_size, &x->max_partition_size);
@@ -4063,6 +4335,8 @@ static void encode_nonrd_sb_row(VP9_COMP *cpi, ThreadData *td,
     x->sb_is_skin = 0;
     x->skip_low_source_sad = 0;
 
+    if (cpi->speed_control.sb_budget > 0) update_sb_time_budget(cpi, td);
+
     if (seg->enabled) {
       const uint8_t *const map =
           seg->update_map ? cpi->segmentation_map : cm->last_frame_seg_map;
@@ -4072,6 +4346,10 @@ static void encode_nonrd_sb_row(VP9_COMP *cpi, ThreadData *td,
         partition_search_type = FIXED_PARTITION;
       }
     }
+    if (cpi->mode_hints.enabled && !seg_skip)
+      partition_search_type = MODE_HINT_PARTITION;
+    else if (x->sb_late && !seg_skip)
+      partition_search_type = FIXED_PARTITION;
 
     // Set the partition type of the 64X64 block
     switch (partition_search_type) {
@@ -4089,9 +4367,29 @@ static void encode_nonrd_sb_row(VP9_COMP *cpi, ThreadData *td,
         nonrd_use_partition(cpi, td, tile_data, mi, tp, mi_row, mi_col,
                             BLOCK_64X64, 1, &dummy_rdc, td->pc_root);
         break;
+      case MODE_HINT_PARTITION:
+        memset(x->variance_low, 0, sizeof(x->variance_low));
+        set_mode_hint_partitioning(cpi, x, xd, BLOCK_64X64, mi_row, mi_col);
+        nonrd_use_partition(cpi, td, tile_data, mi, tp, mi_row, mi_col,
+                            BLOCK_64X64, 1, &dummy_rdc, td->pc_root);
+        break;
       case FIXED_PARTITION:
-        if (!seg_skip) bsize = sf->always_this_block_size;
-        set_fixed_partitioning(cpi, tile_info, mi, mi_row, mi_col, bsize);
+        if (x->sb_late && !seg_skip) {
+          // Reuse the partitioning of the previous frame when it is kept,
+          // else code 32x32 blocks.
+          memset(x->variance_low, 0, sizeof(x->variance_low));
+          if (sf->copy_partition_flag && cpi->rc.frames_since_key > 1) {
+            set_fixed_partitioning(cpi, tile_info, mi, mi_row, mi_col,
+                                   BLOCK_8X8);
+            copy_partitioning_helper(cpi, BLOCK_64X64, mi_row, mi_col);
+          } else {
+            set_fixed_partitioning(cpi, tile_info, mi, mi_row, mi_col,
+                                   BLOCK_32X32);
+          }
+        } else {
+          if (!seg_skip) bsize = sf->always_this_block_size;
+          set_fixed_partitioning(cpi, tile_info, mi, mi_row, mi_col, bsize);
+        }
         nonrd_use_partition(cpi, td, tile_data, mi, tp, mi_row, mi_col,
                             BLOCK_64X64, 1, &dummy_rdc, td->pc_root);
         break;
@@ -4345,6 +4643,8 @@ void vp9_encode_sb_row(VP9_COMP *cpi, ThreadData *td, int tile_row,
          get_token_alloc(MI_BLOCK_SIZE >> 1, tile_mb_cols));
 
   (void)tile_mb_cols;
+
+  if (cpi->pack_sb_rows) vp9_pack_sb_row(cpi, td, tile_row, tile_col, mi_row);
 }
 
 void vp9_encode_tile(VP9_COMP *cpi, ThreadData *td, int tile_row,
@@ -4405,9 +4705,6 @@ static void encode_frame_internal(VP9_COMP *cpi) {
   xd->mi = cm->mi_grid_visible;
   xd->mi[0] = cm->mi;
 
-  vp9_zero(*td->counts);
-  vp9_zero(cpi->td.rd_counts);
-
   xd->lossless = cm->base_qindex == 0 && cm->y_dc_delta_q == 0 &&
                  cm->uv_dc_delta_q == 0 && cm->uv_ac_delta_q == 0;
 
@@ -4427,6 +4724,13 @@ static void encode_frame_internal(VP9_COMP *cpi) {
 
   cm->tx_mode = select_tx_mode(cpi, xd);
 
+  // The header takes the counts of the last frame, so it goes before they are
+  // cleared. The rd costs are then set up with the probabilities it sends.
+  if (cpi->pack_sb_rows) vp9_start_sb_row_packing(cpi);
+
+  vp9_zero(*td->counts);
+  vp9_zero(cpi->td.rd_counts);
+
   vp9_frame_init_quantizer(cpi);
 
   vp9_initialize_rd_consts(cpi);
@@ -4439,6 +4743,10 @@ static void encode_frame_internal(VP9_COMP *cpi) {
   // context cannot be used.
   cm->prev_mi =
       cm->use_prev_frame_mvs ? cm->prev_mip + cm->mi_stride + 1 : NULL;
+  cpi->mode_hints.enabled =
+      cpi->mode_hints.pending && cm->show_frame && !frame_is_intra_only(cm) &&
+      !cpi->use_svc && cpi->mode_hints.rows == cm->mi_rows &&
+      cpi->mode_hints.cols == cm->mi_cols;
 
   x->quant_fp = cpi->sf.use_quant_fp;
   vp9_zero(x->skip_txfm);
@@ -4478,6 +4786,8 @@ static void encode_frame_internal(VP9_COMP *cpi) {
     }
 #endif
 
+    init_sb_time_budget(cpi);
+
     if (!cpi->row_mt) {
       cpi->row_mt_sync_read_ptr = vp9_row_mt_sync_read_dummy;
       cpi->row_mt_sync_write_ptr = vp9_row_mt_sync_write_dummy;
@@ -4547,9 +4857,29 @@ static int compute_frame_aq_offset(struct VP9_COMP *cpi) {
   return sum_delta / (cm->mi_rows * cm->mi_cols);
 }
 
+// Returns 1 if the superblock rows of the frame can be packed as they are
+// encoded. All the frame level coding decisions have to be known before
+// encoding: the probability updates are taken from the last frame, which
+// intra-only frames do not benefit from, and the segment map probabilities
+// come from the coded map. The packing of a tile follows the tile above it, so
+// tile rows have to be encoded by one thread.
+static int can_pack_sb_rows(const VP9_COMP *cpi) {
+  const VP9_COMMON *const cm = &cpi->common;
+  const int tile_cols = 1 << cm->log2_tile_cols;
+
+  return cpi->oxcf.early_packing && !frame_is_intra_only(cm) &&
+         !(cm->seg.enabled && cm->seg.update_map) &&
+         cpi->sf.recode_loop == DISALLOW_RECODE &&
+         cpi->oxcf.aq_mode != LOOKAHEAD_AQ && !cpi->row_mt &&
+         (cm->log2_tile_rows == 0 ||
+          VPXMIN(cpi->oxcf.max_threads, tile_cols) <= 1);
+}
+
 void vp9_encode_frame(VP9_COMP *cpi) {
   VP9_COMMON *const cm = &cpi->common;
 
+  cpi->pack_sb_rows = can_pack_sb_rows(cpi);
+
   // In the longer term the encoder should be generalized to match the
   // decoder such that we allow compound where one of the 3 buffers has a
   // different sign bias and that buffer is then the fixed ref. However, this
@@ -4611,7 +4941,8 @@ void vp9_encode_frame(VP9_COMP *cpi) {
     for (i = 0; i < SWITCHABLE_FILTER_CONTEXTS; ++i)
       filter_thrs[i] = (filter_thrs[i] + rdc->filter_diff[i] / cm->MBs) / 2;
 
-    if (cm->reference_mode == REFERENCE_MODE_SELECT) {
+    // Packed superblock rows keep the frame level modes they were coded with.
+    if (cm->reference_mode == REFERENCE_MODE_SELECT && !cpi->pack_sb_rows) {
       int single_count_zero = 0;
       int comp_count_zero = 0;
 
@@ -4629,7 +4960,7 @@ void vp9_encode_frame(VP9_COMP *cpi) {
       }
     }
 
-    if (cm->tx_mode == TX_MODE_SELECT) {
+    if (cm->tx_mode == TX_MODE_SELECT && !cpi->pack_sb_rows) {
       int count4x4 = 0;
       int count8x8_lp = 0, count8x8_8x8p = 0;
       int count16x16_16x16p = 0, count16x16_lp = 0;
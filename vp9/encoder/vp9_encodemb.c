@@ -49,13 +49,13 @@ void vp9_subtract_plane(MACROBLOCK *x, BLOCK_SIZE bsize, int plane) {
                      pd->dst.buf, pd->dst.stride);
 }
 
+// The part of a trellis node that is needed to trace back the best path. The
+// rate, error and token of a node are only read while it heads the trellis,
+// so they are kept in local variables instead.
 typedef struct vp9_token_state {
-  int64_t error;
-  int rate;
-  int16_t next;
-  int16_t token;
   tran_low_t qc;
   tran_low_t dqc;
+  int16_t next;
   uint8_t best_index;
 } vp9_token_state;
 
@@ -98,8 +98,9 @@ int vp9_optimize_b(MACROBLOCK *mb, int plane, int block, TX_SIZE tx_size,
   struct macroblock_plane *const p = &mb->plane[plane];
   struct macroblockd_plane *const pd = &xd->plane[plane];
   const int ref = is_inter_block(xd->mi[0]);
-  vp9_token_state tokens[1025][2];
+  vp9_token_state tokens[1024][2];
   uint8_t token_cache[1024];
+  uint8_t can_lower[1024];
   const tran_low_t *const coeff = BLOCK_OFFSET(mb->plane[plane].coeff, block);
   tran_low_t *const qcoeff = BLOCK_OFFSET(p->qcoeff, block);
   tran_low_t *const dqcoeff = BLOCK_OFFSET(pd->dqcoeff, block);
@@ -120,6 +121,11 @@ int vp9_optimize_b(MACROBLOCK *mb, int plane, int block, TX_SIZE tx_size,
   int rate0, rate1;
   int64_t error0, error1;
   int16_t t0, t1;
+  // Rate, error and token of both states of the head of the trellis.
+  int head_rate0 = 0, head_rate1 = 0;
+  int64_t head_error0 = 0, head_error1 = 0;
+  int16_t head_token0 = EOB_TOKEN, head_token1 = EOB_TOKEN;
+  int num_can_lower = 0;
   int best, band = (eob < default_eob) ? band_translate[eob]
                                        : band_translate[eob - 1];
   int pt, i, final_eob;
@@ -138,37 +144,48 @@ int vp9_optimize_b(MACROBLOCK *mb, int plane, int block, TX_SIZE tx_size,
   assert((!type && !plane) || (type && plane));
   assert(eob <= default_eob);
 
-  /* Now set up a Viterbi trellis to evaluate alternative roundings. */
-  /* Initialize the sentinel node of the trellis. */
-  tokens[eob][0].rate = 0;
-  tokens[eob][0].error = 0;
-  tokens[eob][0].next = default_eob;
-  tokens[eob][0].token = EOB_TOKEN;
-  tokens[eob][0].qc = 0;
-  tokens[eob][1] = tokens[eob][0];
-
+  // A non-zero coefficient that was rounded up can also be coded one smaller.
   for (i = 0; i < eob; i++) {
     const int rc = scan[i];
-    token_cache[rc] = vp9_pt_energy_class[vp9_get_token(qcoeff[rc])];
+    const int x = qcoeff[rc];
+    token_cache[rc] = vp9_pt_energy_class[vp9_get_token(x)];
+    can_lower[i] = 0;
+    if (x) {
+      const int dqv = dequant_ptr[rc != 0];
+      const int dq_x = abs(x) * dqv;
+      const int scaled_coeff = abs(coeff[rc]) << shift;
+      can_lower[i] = dq_x > scaled_coeff && dq_x < scaled_coeff + dqv;
+      num_can_lower += can_lower[i];
+    }
   }
 
+  // With a single candidate per coefficient the trellis keeps the block as
+  // it was quantized.
+  if (!num_can_lower) return eob;
+
+  /* Now set up a Viterbi trellis to evaluate alternative roundings. The
+   * sentinel node at eob is held in the head state. */
   for (i = eob; i-- > 0;) {
     int base_bits, d2, dx;
     const int rc = scan[i];
     int x = qcoeff[rc];
     /* Only add a trellis state for non-zero coefficients. */
     if (x) {
-      error0 = tokens[next][0].error;
-      error1 = tokens[next][1].error;
+      int rate_best0;
+      int64_t error_best0;
+      int16_t token_best0;
+      error0 = head_error0;
+      error1 = head_error1;
       /* Evaluate the first possibility for this state. */
-      rate0 = tokens[next][0].rate;
-      rate1 = tokens[next][1].rate;
+      rate0 = head_rate0;
+      rate1 = head_rate1;
       base_bits = vp9_get_token_cost(x, &t0, cat6_high_cost);
       /* Consider both possible successor states. */
       if (next < default_eob) {
-        pt = trellis_get_coeff_context(scan, nb, i, t0, token_cache);
-        rate0 += (*token_costs)[0][pt][tokens[next][0].token];
-        rate1 += (*token_costs)[0][pt][tokens[next][1].token];
+        // token_cache already holds the class of the unchanged token.
+        pt = get_coef_context(nb, token_cache, i + 1);
+        rate0 += (*token_costs)[0][pt][head_token0];
+        rate1 += (*token_costs)[0][pt][head_token1];
       }
       UPDATE_RD_COST();
       /* And pick the best. */
@@ -180,25 +197,19 @@ int vp9_optimize_b(MACROBLOCK *mb, int plane, int block, TX_SIZE tx_size,
       }
 #endif  // CONFIG_VP9_HIGHBITDEPTH
       d2 = dx * dx;
-      tokens[i][0].rate = base_bits + (best ? rate1 : rate0);
-      tokens[i][0].error = d2 + (best ? error1 : error0);
+      rate_best0 = base_bits + (best ? rate1 : rate0);
+      error_best0 = d2 + (best ? error1 : error0);
+      token_best0 = t0;
       tokens[i][0].next = next;
-      tokens[i][0].token = t0;
       tokens[i][0].qc = x;
       tokens[i][0].dqc = dqcoeff[rc];
       tokens[i][0].best_index = best;
 
-      /* Evaluate the second possibility for this state. */
-      rate0 = tokens[next][0].rate;
-      rate1 = tokens[next][1].rate;
-
-      if ((abs(x) * dequant_ptr[rc != 0] > (abs(coeff[rc]) << shift)) &&
-          (abs(x) * dequant_ptr[rc != 0] <
-           (abs(coeff[rc]) << shift) + dequant_ptr[rc != 0])) {
-        sz = -(x < 0);
-        x -= 2 * sz + 1;
-      } else {
+      if (!can_lower[i]) {
         tokens[i][1] = tokens[i][0];
+        head_rate0 = head_rate1 = rate_best0;
+        head_error0 = head_error1 = error_best0;
+        head_token0 = head_token1 = token_best0;
         next = i;
 
         if (!(--band_left)) {
@@ -209,27 +220,31 @@ int vp9_optimize_b(MACROBLOCK *mb, int plane, int block, TX_SIZE tx_size,
         continue;
       }
 
+      /* Evaluate the second possibility for this state. */
+      rate0 = head_rate0;
+      rate1 = head_rate1;
+      sz = -(x < 0);
+      x -= 2 * sz + 1;
+
       /* Consider both possible successor states. */
       if (!x) {
         /* If we reduced this coefficient to zero, check to see if
          *  we need to move the EOB back here.
          */
-        t0 = tokens[next][0].token == EOB_TOKEN ? EOB_TOKEN : ZERO_TOKEN;
-        t1 = tokens[next][1].token == EOB_TOKEN ? EOB_TOKEN : ZERO_TOKEN;
+        t0 = head_token0 == EOB_TOKEN ? EOB_TOKEN : ZERO_TOKEN;
+        t1 = head_token1 == EOB_TOKEN ? EOB_TOKEN : ZERO_TOKEN;
         base_bits = 0;
       } else {
         base_bits = vp9_get_token_cost(x, &t0, cat6_high_cost);
         t1 = t0;
       }
-      if (next < default_eob) {
-        if (t0 != EOB_TOKEN) {
-          pt = trellis_get_coeff_context(scan, nb, i, t0, token_cache);
-          rate0 += (*token_costs)[!x][pt][tokens[next][0].token];
-        }
-        if (t1 != EOB_TOKEN) {
-          pt = trellis_get_coeff_context(scan, nb, i, t1, token_cache);
-          rate1 += (*token_costs)[!x][pt][tokens[next][1].token];
-        }
+      // t0 and t1 only differ when one of them is EOB_TOKEN, so the context
+      // of the next coefficient is the same for both.
+      if (next < default_eob && (t0 != EOB_TOKEN || t1 != EOB_TOKEN)) {
+        pt = trellis_get_coeff_context(scan, nb, i,
+                                       t0 != EOB_TOKEN ? t0 : t1, token_cache);
+        if (t0 != EOB_TOKEN) rate0 += (*token_costs)[!x][pt][head_token0];
+        if (t1 != EOB_TOKEN) rate1 += (*token_costs)[!x][pt][head_token1];
       }
 
       UPDATE_RD_COST();
@@ -247,10 +262,10 @@ int vp9_optimize_b(MACROBLOCK *mb, int plane, int block, TX_SIZE tx_size,
 #endif  // CONFIG_VP9_HIGHBITDEPTH
       d2 = dx * dx;
 
-      tokens[i][1].rate = base_bits + (best ? rate1 : rate0);
-      tokens[i][1].error = d2 + (best ? error1 : error0);
+      head_rate1 = base_bits + (best ? rate1 : rate0);
+      head_error1 = d2 + (best ? error1 : error0);
+      head_token1 = best ? t1 : t0;
       tokens[i][1].next = next;
-      tokens[i][1].token = best ? t1 : t0;
       tokens[i][1].qc = x;
 
       if (x) {
@@ -271,24 +286,24 @@ int vp9_optimize_b(MACROBLOCK *mb, int plane, int block, TX_SIZE tx_size,
 
       tokens[i][1].best_index = best;
       /* Finally, make this the new head of the trellis. */
+      head_rate0 = rate_best0;
+      head_error0 = error_best0;
+      head_token0 = token_best0;
       next = i;
     } else {
       /* There's no choice to make for a zero coefficient, so we don't
        *  add a new trellis node, but we do need to update the costs.
        */
       pt = get_coef_context(nb, token_cache, i + 1);
-      t0 = tokens[next][0].token;
-      t1 = tokens[next][1].token;
       /* Update the cost of each path if we're past the EOB token. */
-      if (t0 != EOB_TOKEN) {
-        tokens[next][0].rate += (*token_costs)[1][pt][t0];
-        tokens[next][0].token = ZERO_TOKEN;
+      if (head_token0 != EOB_TOKEN) {
+        head_rate0 += (*token_costs)[1][pt][head_token0];
+        head_token0 = ZERO_TOKEN;
       }
-      if (t1 != EOB_TOKEN) {
-        tokens[next][1].rate += (*token_costs)[1][pt][t1];
-        tokens[next][1].token = ZERO_TOKEN;
+      if (head_token1 != EOB_TOKEN) {
+        head_rate1 += (*token_costs)[1][pt][head_token1];
+        head_token1 = ZERO_TOKEN;
       }
-      tokens[i][0].best_index = tokens[i][1].best_index = 0;
       /* Don't update next, because we didn't add a new node. */
     }
 
@@ -300,14 +315,10 @@ int vp9_optimize_b(MACROBLOCK *mb, int plane, int block, TX_SIZE tx_size,
   }
 
   /* Now pick the best path through the whole trellis. */
-  rate0 = tokens[next][0].rate;
-  rate1 = tokens[next][1].rate;
-  error0 = tokens[next][0].error;
-  error1 = tokens[next][1].error;
-  t0 = tokens[next][0].token;
-  t1 = tokens[next][1].token;
-  rate0 += (*token_costs)[0][ctx][t0];
-  rate1 += (*token_costs)[0][ctx][t1];
+  rate0 = head_rate0 + (*token_costs)[0][ctx][head_token0];
+  rate1 = head_rate1 + (*token_costs)[0][ctx][head_token1];
+  error0 = head_error0;
+  error1 = head_error1;
   UPDATE_RD_COST();
   best = rd_cost1 < rd_cost0;
   final_eob = -1;
@@ -26,8 +26,9 @@ void vp9_encode_mv(VP9_COMP *cpi, vpx_writer *w, const MV *mv, const MV *ref,
                    const nmv_context *mvctx, int usehp,
                    unsigned int *const max_mv_magnitude);
 
-void vp9_build_nmv_cost_table(int *mvjoint, int *mvcost[2],
-                              const nmv_context *mvctx, int usehp);
+void vp9_build_nmv_component_cost_table(int *mvcost,
+                                        const nmv_component *const mvcomp,
+                                        int usehp);
 
 void vp9_update_mv_count(ThreadData *td);
 
@@ -251,6 +251,76 @@ VP9_LEVEL vp9_get_level(const Vp9LevelSpec *const level_spec) {
   return (i == VP9_LEVELS) ? LEVEL_UNKNOWN : vp9_level_defs[i].level;
 }
 
+// Returns the block size of the given dimensions in pixels, or BLOCK_INVALID.
+static BLOCK_SIZE get_block_size(int width, int height) {
+  BLOCK_SIZE bsize;
+  for (bsize = BLOCK_4X4; bsize < BLOCK_SIZES; ++bsize) {
+    if ((4 << b_width_log2_lookup[bsize]) == width &&
+        (4 << b_height_log2_lookup[bsize]) == height)
+      return bsize;
+  }
+  return BLOCK_INVALID;
+}
+
+int vp9_set_mode_hints(VP9_COMP *cpi, const vpx_block_mode_info_t *blocks,
+                       int rows, int cols) {
+  ModeHints *const mode_hints = &cpi->mode_hints;
+  int i;
+
+  mode_hints->pending = 0;
+  if (blocks == NULL) return 0;
+  if (rows <= 0 || cols <= 0) return -1;
+
+  if (rows * cols > mode_hints->size) {
+    vpx_free(mode_hints->hints);
+    mode_hints->size = 0;
+    mode_hints->hints =
+        (MODE_HINT *)vpx_malloc(rows * cols * sizeof(*mode_hints->hints));
+    if (mode_hints->hints == NULL) return -1;
+    mode_hints->size = rows * cols;
+  }
+
+  for (i = 0; i < rows * cols; ++i) {
+    const vpx_block_mode_info_t *const block = &blocks[i];
+    MODE_HINT *const hint = &mode_hints->hints[i];
+    hint->sb_type = get_block_size(block->width, block->height);
+    if (hint->sb_type == BLOCK_INVALID) return -1;
+    if (block->ref_frame[0] == LAST_FRAME) {
+      hint->mv.as_mv.row = block->mv_row[0];
+      hint->mv.as_mv.col = block->mv_col[0];
+    } else {
+      hint->mv.as_int = INVALID_MV;
+    }
+  }
+
+  mode_hints->rows = rows;
+  mode_hints->cols = cols;
+  mode_hints->pending = 1;
+  return 0;
+}
+
+// The speed control moves between the speeds of the same real-time search
+// path as the application speed: the rd search below 5, the non-rd search
+// from 5 on.
+static int speed_control_max_speed(const SpeedControl *sc) {
+  return sc->min_speed < 5 ? 4 : 8;
+}
+
+int vp9_set_speed_target(VP9_COMP *cpi, int target_time, int percentile) {
+  SpeedControl *const sc = &cpi->speed_control;
+
+  if (target_time < 0 || percentile < 1 || percentile > 100) return -1;
+
+  // Start from the application speed, or keep the current one when only the
+  // target changes.
+  if (sc->target_time == 0) sc->speed = sc->min_speed;
+  if (target_time == 0) cpi->oxcf.speed = sc->min_speed;
+  sc->target_time = target_time;
+  sc->percentile = percentile;
+  sc->num_frames = 0;
+  return 0;
+}
+
 int vp9_set_active_map(VP9_COMP *cpi, unsigned char *new_map_16x16, int rows,
                        int cols) {
   if (rows == cpi->common.mb_rows && cols == cpi->common.mb_cols) {
@@ -475,6 +545,15 @@ static void dealloc_compressor_data(VP9_COMP *cpi) {
   vpx_free(cpi->active_map.map);
   cpi->active_map.map = NULL;
 
+  vpx_free(cpi->mode_hints.hints);
+  vp9_zero(cpi->mode_hints);
+
+  for (i = LAST_FRAME; i <= ALTREF_FRAME; ++i) {
+    vpx_free(cpi->temporal_mv.mvs[i]);
+    cpi->temporal_mv.mvs[i] = NULL;
+  }
+  cpi->temporal_mv.rows = cpi->temporal_mv.cols = 0;
+
   vpx_free(cpi->consec_zero_mv);
   cpi->consec_zero_mv = NULL;
 
@@ -501,6 +580,14 @@ static void dealloc_compressor_data(VP9_COMP *cpi) {
   vpx_free(cpi->tplist[0][0]);
   cpi->tplist[0][0] = NULL;
 
+  vpx_free(cpi->packed_header);
+  cpi->packed_header = NULL;
+  vpx_free(cpi->tile_pack_buf);
+  cpi->tile_pack_buf = NULL;
+  cpi->tile_pack_buf_size = 0;
+  vpx_free(cpi->pack_seg_context);
+  cpi->pack_seg_context = NULL;
+
   vp9_free_pc_tree(&cpi->td);
 
   for (i = 0; i < cpi->svc.number_spatial_layers; ++i) {
@@ -574,6 +661,7 @@ static void restore_coding_context(VP9_COMP *cpi) {
          MV_VALS * sizeof(*cc->nmvcosts_hp[0]));
   memcpy(cpi->nmvcosts_hp[1], cc->nmvcosts_hp[1],
          MV_VALS * sizeof(*cc->nmvcosts_hp[1]));
+  vp9_invalidate_mv_costs(&cpi->rd);
 
   vp9_copy(cm->seg.pred_probs, cc->segment_pred_probs);
 
@@ -855,6 +943,11 @@ static void alloc_compressor_data(VP9_COMP *cpi) {
       cm, cpi->tplist[0][0],
       vpx_calloc(sb_rows * 4 * (1 << 6), sizeof(*cpi->tplist[0][0])));
 
+  vpx_free(cpi->pack_seg_context);
+  CHECK_MEM_ERROR(cm, cpi->pack_seg_context,
+                  vpx_calloc(mi_cols_aligned_to_sb(cm->mi_cols),
+                             sizeof(*cpi->pack_seg_context)));
+
   vp9_setup_pc_tree(&cpi->common, &cpi->td);
 }
 
@@ -1473,6 +1566,7 @@ void vp9_change_config(struct VP9_COMP *cpi, const VP9EncoderConfig *oxcf) {
 #if CONFIG_VP9_HIGHBITDEPTH
   cpi->td.mb.e_mbd.bd = (int)cm->bit_depth;
 #endif  // CONFIG_VP9_HIGHBITDEPTH
+  cpi->speed_control.min_speed = cpi->oxcf.speed;
 
   if ((oxcf->pass == 0) && (oxcf->rc_mode == VPX_Q)) {
     rc->baseline_gf_interval = FIXED_GF_INTERVAL;
@@ -1882,7 +1976,11 @@ VP9_COMP *vp9_create_compressor(VP9EncoderConfig *oxcf,
 
       cpi->twopass.stats_in_start = oxcf->two_pass_stats_in.buf;
       cpi->twopass.stats_in = cpi->twopass.stats_in_start;
-      cpi->twopass.stats_in_end = &cpi->twopass.stats_in[packets - 1];
+      cpi->twopass.num_chunks = vp9_count_stats_eos_packets(
+          cpi->twopass.stats_in_start, packets);
+      cpi->twopass.stats_in_eos =
+          &cpi->twopass.stats_in[packets - cpi->twopass.num_chunks];
+      cpi->twopass.stats_in_end = cpi->twopass.stats_in_eos;
 
       vp9_init_second_pass(cpi);
     }
@@ -2148,6 +2246,50 @@ void vp9_remove_compressor(VP9_COMP *cpi) {
 #endif
 }
 
+// Picks the speed of the next frame from the encode times of the last
+// frames, and reports it in a VPX_CODEC_SPEED_PKT.
+static void update_speed_control(VP9_COMP *cpi, int64_t time) {
+  SpeedControl *const sc = &cpi->speed_control;
+  const int64_t target_time = sc->target_time;
+  // Frames of a window allowed to go over the target.
+  const int max_late = (100 - sc->percentile) * SPEED_CONTROL_WINDOW / 100;
+  struct vpx_codec_cx_pkt pkt;
+  int num_frames;
+  int late = 0;
+  int slow = 0;
+  int i;
+
+  sc->times[sc->num_frames % SPEED_CONTROL_WINDOW] = time;
+  ++sc->num_frames;
+  num_frames = VPXMIN(sc->num_frames, SPEED_CONTROL_WINDOW);
+  for (i = 0; i < num_frames; ++i) {
+    late += sc->times[i] > target_time;
+    slow += sc->times[i] * 4 > target_time * 3;
+  }
+
+  pkt.kind = VPX_CODEC_SPEED_PKT;
+  pkt.data.speed.encode_time = (unsigned int)VPXMIN(time, UINT_MAX);
+  pkt.data.speed.speed = cpi->oxcf.speed;
+  pkt.data.speed.late_blocks = cpi->td.rd_counts.late_sbs;
+
+  if (late > max_late) {
+    // The target is missed for more frames than the percentile allows.
+    if (sc->speed < speed_control_max_speed(sc)) {
+      ++sc->speed;
+      sc->num_frames = 0;
+    }
+  } else if (num_frames == SPEED_CONTROL_WINDOW && slow <= max_late &&
+             sc->speed > sc->min_speed) {
+    // A whole window met the target with a 25% margin, go back to a slower
+    // speed for better quality.
+    --sc->speed;
+    sc->num_frames = 0;
+  }
+
+  pkt.data.speed.next_speed = sc->speed;
+  vpx_codec_pkt_list_add(cpi->output_pkt_list, &pkt);
+}
+
 static void generate_psnr_packet(VP9_COMP *cpi) {
   struct vpx_codec_cx_pkt pkt;
   int i;
@@ -3917,6 +4059,61 @@ static void vp9_try_disable_lookahead_aq(VP9_COMP *cpi, size_t *size,
     }
 }
 
+static void update_temporal_mv_field(VP9_COMP *cpi) {
+  VP9_COMMON *const cm = &cpi->common;
+  TemporalMvField *const field = &cpi->temporal_mv;
+  int64_t ref_dist[MAX_REF_FRAMES] = { 0 };
+  int ref, mi_row, mi_col;
+
+  field->buf_ts[cm->new_fb_idx] = field->frame_ts;
+  if (!cpi->sf.mv.use_temporal_mv) return;
+
+  if (field->rows != cm->mi_rows || field->cols != cm->mi_cols) {
+    for (ref = LAST_FRAME; ref <= ALTREF_FRAME; ++ref) {
+      vpx_free(field->mvs[ref]);
+      field->mvs[ref] = NULL;
+    }
+    field->rows = field->cols = 0;
+    for (ref = LAST_FRAME; ref <= ALTREF_FRAME; ++ref) {
+      CHECK_MEM_ERROR(cm, field->mvs[ref],
+                      (TEMPORAL_MV *)vpx_calloc(cm->mi_rows * cm->mi_cols,
+                                                sizeof(*field->mvs[ref])));
+    }
+    field->rows = cm->mi_rows;
+    field->cols = cm->mi_cols;
+  }
+
+  if (frame_is_intra_only(cm)) {
+    for (ref = LAST_FRAME; ref <= ALTREF_FRAME; ++ref)
+      memset(field->mvs[ref], 0,
+             field->rows * field->cols * sizeof(*field->mvs[ref]));
+    return;
+  }
+
+  for (ref = LAST_FRAME; ref <= ALTREF_FRAME; ++ref) {
+    const int buf_idx = get_ref_frame_buf_idx(cpi, ref);
+    if (buf_idx != INVALID_IDX)
+      ref_dist[ref] = field->frame_ts - field->buf_ts[buf_idx];
+  }
+
+  for (mi_row = 0; mi_row < cm->mi_rows; ++mi_row) {
+    for (mi_col = 0; mi_col < cm->mi_cols; ++mi_col) {
+      const MODE_INFO *const mi =
+          cm->mi_grid_visible[mi_row * cm->mi_stride + mi_col];
+      int i;
+      if (!is_inter_block(mi)) continue;
+      for (i = 0; i < 1 + has_second_ref(mi); ++i) {
+        const int64_t dist = ref_dist[mi->ref_frame[i]];
+        TEMPORAL_MV *tmv;
+        if (dist == 0) continue;
+        tmv = &field->mvs[mi->ref_frame[i]][mi_row * cm->mi_cols + mi_col];
+        tmv->mv = mi->mv[i];
+        tmv->dist = dist;
+      }
+    }
+  }
+}
+
 static void encode_frame_to_data_rate(VP9_COMP *cpi, size_t *size,
                                       uint8_t *dest,
                                       unsigned int *frame_flags) {
@@ -4096,6 +4293,7 @@ static void encode_frame_to_data_rate(VP9_COMP *cpi, size_t *size,
   if (frame_is_intra_only(cm) == 0) {
     release_scaled_references(cpi);
   }
+  update_temporal_mv_field(cpi);
   vp9_update_reference_frames(cpi);
 
   for (t = TX_4X4; t <= TX_32X32; t++)
@@ -4193,6 +4391,55 @@ static void Pass0Encode(VP9_COMP *cpi, size_t *size, uint8_t *dest,
   encode_frame_to_data_rate(cpi, size, dest, frame_flags);
 }
 
+#if CONFIG_MULTI_RES_ENCODING
+// Follows the frame type of the lower resolution encoder, which has already
+// coded this input frame, and checks whether its motion field can be reused:
+// both encoders must predict from the same LAST_FRAME input.
+static void mr_setup_frame(VP9_COMP *cpi) {
+  const LOWER_RES_FRAME_INFO *const info = cpi->oxcf.mr_low_res_frame_info;
+
+  cpi->mr_low_res_mv_avail = 0;
+  if (cpi->oxcf.mr_encoder_id == 0) return;
+
+  if (info->frame_type == KEY_FRAME) cpi->frame_flags |= FRAMEFLAGS_KEY;
+  cpi->mr_low_res_mv_avail = !info->is_frame_dropped &&
+                             info->frame_type != KEY_FRAME &&
+                             info->last_frame_index == cpi->mr_last_frame_index;
+}
+
+// Saves the motion field of the frame for the next higher resolution encoder.
+static void mr_store_frame_info(VP9_COMP *cpi, size_t size) {
+  VP9_COMMON *const cm = &cpi->common;
+  LOWER_RES_FRAME_INFO *const info = cpi->oxcf.mr_low_res_frame_info;
+
+  if (cpi->oxcf.mr_encoder_id < cpi->oxcf.mr_total_resolutions - 1) {
+    info->is_frame_dropped = size == 0;
+    if (size > 0) {
+      int mi_row, mi_col;
+      info->frame_type = cm->frame_type;
+      info->last_frame_index = cpi->mr_last_frame_index;
+      info->width = cm->width;
+      info->height = cm->height;
+      info->mi_rows = cm->mi_rows;
+      info->mi_cols = cm->mi_cols;
+      for (mi_row = 0; mi_row < cm->mi_rows; ++mi_row) {
+        for (mi_col = 0; mi_col < cm->mi_cols; ++mi_col) {
+          // The mode info of the shown frame has been swapped into prev_mi.
+          const MODE_INFO *const mi =
+              cm->prev_mi_grid_visible[mi_row * cm->mi_stride + mi_col];
+          info->mvs[mi_row * cm->mi_cols + mi_col].as_int =
+              mi->ref_frame[0] == LAST_FRAME ? mi->mv[0].as_int : INVALID_MV;
+        }
+      }
+    }
+  }
+
+  if (size > 0 && cpi->refresh_last_frame)
+    cpi->mr_last_frame_index = cpi->mr_frame_index;
+  ++cpi->mr_frame_index;
+}
+#endif  // CONFIG_MULTI_RES_ENCODING
+
 static void Pass2Encode(VP9_COMP *cpi, size_t *size, uint8_t *dest,
                         unsigned int *frame_flags) {
   cpi->allow_encode_breakout = ENCODE_BREAKOUT_ENABLED;
@@ -4637,6 +4884,14 @@ int vp9_get_compressed_data(VP9_COMP *cpi, unsigned int *frame_flags,
 
   vpx_usec_timer_start(&cmptimer);
 
+  if (use_speed_control(cpi)) {
+    SpeedControl *const sc = &cpi->speed_control;
+    sc->speed = clamp(sc->speed, sc->min_speed, speed_control_max_speed(sc));
+    cpi->oxcf.speed = sc->speed;
+    vpx_usec_timer_start(&sc->frame_timer);
+    cpi->td.rd_counts.late_sbs = 0;
+  }
+
   vp9_set_high_precision_mv(cpi, ALTREF_HIGH_PRECISION_MV);
 
   // Is multi-arf enabled.
@@ -4772,6 +5027,7 @@ int vp9_get_compressed_data(VP9_COMP *cpi, unsigned int *frame_flags,
 
     *time_stamp = source->ts_start;
     *time_end = source->ts_end;
+    cpi->temporal_mv.frame_ts = source->ts_start;
     *frame_flags = (source->flags & VPX_EFLAG_FORCE_KF) ? FRAMEFLAGS_KEY : 0;
 
   } else {
@@ -4864,9 +5120,18 @@ int vp9_get_compressed_data(VP9_COMP *cpi, unsigned int *frame_flags,
     SvcEncode(cpi, size, dest, frame_flags);
   } else {
     // One pass encode
+#if CONFIG_MULTI_RES_ENCODING
+    if (oxcf->mr_total_resolutions > 1) mr_setup_frame(cpi);
+#endif
     Pass0Encode(cpi, size, dest, frame_flags);
+#if CONFIG_MULTI_RES_ENCODING
+    if (oxcf->mr_total_resolutions > 1) mr_store_frame_info(cpi, *size);
+#endif
   }
 
+  // Mode hints only apply to the frame coded after they were set.
+  cpi->mode_hints.pending = 0;
+
   if (cm->refresh_frame_context)
     cm->frame_contexts[cm->frame_context_idx] = *cm->fc;
 
@@ -4889,6 +5154,9 @@ int vp9_get_compressed_data(VP9_COMP *cpi, unsigned int *frame_flags,
   vpx_usec_timer_mark(&cmptimer);
   cpi->time_compress_data += vpx_usec_timer_elapsed(&cmptimer);
 
+  if (use_speed_control(cpi))
+    update_speed_control(cpi, vpx_usec_timer_elapsed(&cmptimer));
+
   // Should we calculate metrics for the frame.
   if (is_psnr_calc_enabled(cpi)) generate_psnr_packet(cpi);
 
@@ -21,6 +21,7 @@
 #endif
 #include "vpx_dsp/variance.h"
 #include "vpx_ports/system_state.h"
+#include "vpx_ports/vpx_timer.h"
 #include "vpx_util/vpx_thread.h"
 
 #include "vp9/common/vp9_alloccommon.h"
@@ -139,6 +140,25 @@ typedef enum {
   kHighSadHighSumdiff = 4,
 } CONTENT_STATE_SB;
 
+#if CONFIG_MULTI_RES_ENCODING
+// Information about the frame just coded by a multi-resolution encoder, read
+// by the encoder of the next higher resolution.
+typedef struct {
+  FRAME_TYPE frame_type;
+  int is_frame_dropped;
+  // Index of the input frame held in the LAST_FRAME buffer when the frame was
+  // coded.
+  unsigned int last_frame_index;
+  int width;
+  int height;
+  int mi_rows;
+  int mi_cols;
+  // LAST_FRAME motion vector of each 8x8 block, INVALID_MV if the block was
+  // not predicted from LAST_FRAME.
+  int_mv *mvs;
+} LOWER_RES_FRAME_INFO;
+#endif
+
 typedef struct VP9EncoderConfig {
   BITSTREAM_PROFILE profile;
   vpx_bit_depth_t bit_depth;     // Codec bit-depth.
@@ -250,6 +270,9 @@ typedef struct VP9EncoderConfig {
   unsigned int target_level;
 
   vpx_fixed_buf_t two_pass_stats_in;
+  // Index of the stitched first pass chunk to encode in the second pass, or
+  // -1 to encode the whole stream.
+  int two_pass_chunk;
   struct vpx_codec_pkt_list *output_pkt_list;
 
 #if CONFIG_FP_MB_STATS
@@ -269,6 +292,16 @@ typedef struct VP9EncoderConfig {
 
   int row_mt;
   unsigned int row_mt_bit_exact;
+
+  int early_packing;
+
+#if CONFIG_MULTI_RES_ENCODING
+  int mr_total_resolutions;
+  // 0 for the lowest resolution.
+  int mr_encoder_id;
+  vpx_rational_t mr_down_sampling_factor;
+  LOWER_RES_FRAME_INFO *mr_low_res_frame_info;
+#endif
 } VP9EncoderConfig;
 
 static INLINE int is_lossless_requested(const VP9EncoderConfig *cfg) {
@@ -291,6 +324,12 @@ typedef struct TileDataEnc {
   pthread_mutex_t *search_count_mutex;
   pthread_mutex_t *enc_row_mt_mutex;
 #endif
+
+  // Bitstream of the tile when its superblock rows are packed as they are
+  // encoded, and the stats gathered while packing it.
+  vpx_writer pack_bc;
+  unsigned int max_mv_magnitude;
+  int interp_filter_selected[1][SWITCHABLE];
 } TileDataEnc;
 
 typedef struct RowMTInfo {
@@ -327,6 +366,7 @@ typedef struct RD_COUNTS {
   vp9_coeff_count coef_counts[TX_SIZES][PLANE_TYPES];
   int64_t comp_pred_diff[REFERENCE_MODES];
   int64_t filter_diff[SWITCHABLE_FILTER_CONTEXTS];
+  int late_sbs;  // Superblocks coded behind the time budget.
 } RD_COUNTS;
 
 typedef struct ThreadData {
@@ -347,6 +387,58 @@ typedef struct ActiveMap {
   unsigned char *map;
 } ActiveMap;
 
+typedef struct {
+  BLOCK_SIZE sb_type;
+  int_mv mv;  // LAST_FRAME motion vector, or INVALID_MV.
+} MODE_HINT;
+
+// Mode info of the frame being transcoded, set with VP9E_SET_MODE_INFO_HINTS.
+typedef struct ModeHints {
+  int pending;  // Hints were set for the next frame coded.
+  int enabled;  // The frame being coded uses the hints.
+  int rows;
+  int cols;
+  int size;  // Number of allocated hints.
+  MODE_HINT *hints;  // One per 8x8 block, in raster order.
+} ModeHints;
+
+typedef struct {
+  int_mv mv;
+  int64_t dist;  // Source time stamp distance spanned by mv, 0 if unset.
+} TEMPORAL_MV;
+
+// Latest motion vector towards each reference frame of the 8x8 blocks of the
+// frames coded so far. Scaled by temporal distance, it seeds the motion search
+// of the co-located blocks of later frames.
+typedef struct TemporalMvField {
+  int rows;
+  int cols;
+  TEMPORAL_MV *mvs[MAX_REF_FRAMES];  // LAST_FRAME to ALTREF_FRAME.
+  int64_t frame_ts;  // Source time stamp of the frame being coded.
+  int64_t buf_ts[FRAME_BUFFERS];  // Source time stamp of each frame buffer.
+} TemporalMvField;
+
+// Number of frames whose encode times the speed control looks at.
+#define SPEED_CONTROL_WINDOW 30
+
+// Adapts the speed of real-time encoding to a frame encode time target, set
+// with VP9E_SET_SPEED_TARGET.
+typedef struct SpeedControl {
+  int target_time;  // Encode time target in microseconds, 0 when off.
+  int percentile;   // Percentage of frames to encode within target_time.
+  int min_speed;    // Speed set by the application.
+  int speed;        // Speed of the next frame.
+  int num_frames;   // Frames encoded since the last speed change.
+  int64_t times[SPEED_CONTROL_WINDOW];  // Encode times of the last frames.
+
+  // Superblocks are given a share of the target, and are coded with faster
+  // searches when their thread is behind it.
+  struct vpx_usec_timer frame_timer;  // Started with the frame.
+  int64_t sb_start_time;  // Frame time when superblock coding started.
+  int64_t sb_budget;      // Superblock coding time of a thread, 0 when off.
+  int sbs_per_thread;     // Superblocks coded by each thread.
+} SpeedControl;
+
 typedef enum { Y, U, V, ALL } STAT_TYPE;
 
 typedef struct IMAGE_STAT {
@@ -502,6 +594,17 @@ typedef struct VP9_COMP {
   uint32_t tok_count[4][1 << 6];
   TOKENLIST *tplist[4][1 << 6];
 
+  // Set when the superblock rows of the frame are packed as they are encoded
+  // (see VP9E_SET_EARLY_PACKING). The compressed header is then written before
+  // the frame is encoded, and each tile is packed to its own part of
+  // tile_pack_buf.
+  int pack_sb_rows;
+  uint8_t *packed_header;
+  size_t packed_header_size;
+  uint8_t *tile_pack_buf;
+  size_t tile_pack_buf_size;
+  PARTITION_CONTEXT *pack_seg_context;
+
   // Ambient reconstruction err target for force key frames
   int64_t ambient_err;
 
@@ -551,6 +654,9 @@ typedef struct VP9_COMP {
 
   CYCLIC_REFRESH *cyclic_refresh;
   ActiveMap active_map;
+  ModeHints mode_hints;
+  TemporalMvField temporal_mv;
+  SpeedControl speed_control;
 
   fractional_mv_step_fp *find_fractional_mv_step;
   vp9_full_search_fn_t full_search_sad;
@@ -716,6 +822,14 @@ typedef struct VP9_COMP {
   uint8_t *content_state_sb_fd;
 
   LevelConstraint level_constraint;
+
+#if CONFIG_MULTI_RES_ENCODING
+  // Set when the motion of the lower resolution frame can seed the motion
+  // search of the current frame.
+  int mr_low_res_mv_avail;
+  unsigned int mr_frame_index;
+  unsigned int mr_last_frame_index;
+#endif
 } VP9_COMP;
 
 void vp9_initialize_enc(void);
@@ -755,6 +869,11 @@ int vp9_set_active_map(VP9_COMP *cpi, unsigned char *map, int rows, int cols);
 
 int vp9_get_active_map(VP9_COMP *cpi, unsigned char *map, int rows, int cols);
 
+int vp9_set_mode_hints(VP9_COMP *cpi, const vpx_block_mode_info_t *blocks,
+                       int rows, int cols);
+
+int vp9_set_speed_target(VP9_COMP *cpi, int target_time, int percentile);
+
 int vp9_set_internal_size(VP9_COMP *cpi, VPX_SCALING horiz_mode,
                           VPX_SCALING vert_mode);
 
@@ -860,6 +979,32 @@ static INLINE int is_one_pass_cbr_svc(const struct VP9_COMP *const cpi) {
   return (cpi->use_svc && cpi->oxcf.pass == 0);
 }
 
+static INLINE int use_speed_control(const struct VP9_COMP *const cpi) {
+  return cpi->speed_control.target_time > 0 && cpi->oxcf.mode == REALTIME &&
+         cpi->oxcf.pass == 0 && !cpi->use_svc;
+}
+
+// Superblocks coded behind the time budget of the speed control skip the
+// sub-pixel motion search.
+static INLINE fractional_mv_step_fp *get_fractional_mv_step(
+    const struct VP9_COMP *const cpi, const MACROBLOCK *const x) {
+  return x->sb_late ? vp9_skip_sub_pixel_tree : cpi->find_fractional_mv_step;
+}
+
+// Returns 1 if the motion of the lower resolution frame coded just before
+// this one can be used as a hint: the lower spatial layer of an SVC
+// superframe, or the frame of the lower resolution encoder. Mode hints give
+// the motion of the frame being coded itself.
+static INLINE int base_mv_avail(const struct VP9_COMP *const cpi) {
+  const SVC *const svc = &cpi->svc;
+  if (cpi->mode_hints.enabled) return 1;
+#if CONFIG_MULTI_RES_ENCODING
+  if (cpi->mr_low_res_mv_avail) return 1;
+#endif
+  return svc->use_base_mv && svc->spatial_layer_id &&
+         !svc->layer_context[svc->temporal_layer_id].is_key_frame;
+}
+
 #if CONFIG_VP9_TEMPORAL_DENOISING
 static INLINE int denoise_svc(const struct VP9_COMP *const cpi) {
   return (!cpi->use_svc ||
@@ -293,9 +293,6 @@ void vp9_end_first_pass(VP9_COMP *cpi) {
   } else {
     output_stats(&cpi->twopass.total_stats, cpi->output_pkt_list);
   }
-
-  vpx_free(cpi->twopass.fp_mb_float_stats);
-  cpi->twopass.fp_mb_float_stats = NULL;
 }
 
 static vpx_variance_fn_t get_block_variance_fn(BLOCK_SIZE bsize) {
@@ -656,28 +653,6 @@ static int fp_estimate_block_noise(MACROBLOCK *x, BLOCK_SIZE bsize) {
   return block_noise << 2;  // Scale << 2 to account for sampling.
 }
 
-// This function is called to test the functionality of row based
-// multi-threading in unit tests for bit-exactness
-static void accumulate_floating_point_stats(VP9_COMP *cpi,
-                                            TileDataEnc *first_tile_col) {
-  VP9_COMMON *const cm = &cpi->common;
-  int mb_row, mb_col;
-  first_tile_col->fp_data.intra_factor = 0;
-  first_tile_col->fp_data.brightness_factor = 0;
-  first_tile_col->fp_data.neutral_count = 0;
-  for (mb_row = 0; mb_row < cm->mb_rows; ++mb_row) {
-    for (mb_col = 0; mb_col < cm->mb_cols; ++mb_col) {
-      const int mb_index = mb_row * cm->mb_cols + mb_col;
-      first_tile_col->fp_data.intra_factor +=
-          cpi->twopass.fp_mb_float_stats[mb_index].frame_mb_intra_factor;
-      first_tile_col->fp_data.brightness_factor +=
-          cpi->twopass.fp_mb_float_stats[mb_index].frame_mb_brightness_factor;
-      first_tile_col->fp_data.neutral_count +=
-          cpi->twopass.fp_mb_float_stats[mb_index].frame_mb_neutral_count;
-    }
-  }
-}
-
 static void first_pass_stat_calc(VP9_COMP *cpi, FIRSTPASS_STATS *fps,
                                  FIRSTPASS_DATA *fp_acc_data) {
   VP9_COMMON *const cm = &cpi->common;
@@ -755,35 +730,40 @@ static void first_pass_stat_calc(VP9_COMP *cpi, FIRSTPASS_STATS *fps,
   }
 }
 
-static void accumulate_fp_mb_row_stat(TileDataEnc *this_tile,
-                                      FIRSTPASS_DATA *fp_acc_data) {
-  this_tile->fp_data.intra_factor += fp_acc_data->intra_factor;
-  this_tile->fp_data.brightness_factor += fp_acc_data->brightness_factor;
-  this_tile->fp_data.coded_error += fp_acc_data->coded_error;
-  this_tile->fp_data.sr_coded_error += fp_acc_data->sr_coded_error;
-  this_tile->fp_data.frame_noise_energy += fp_acc_data->frame_noise_energy;
-  this_tile->fp_data.intra_error += fp_acc_data->intra_error;
-  this_tile->fp_data.intercount += fp_acc_data->intercount;
-  this_tile->fp_data.second_ref_count += fp_acc_data->second_ref_count;
-  this_tile->fp_data.neutral_count += fp_acc_data->neutral_count;
-  this_tile->fp_data.intra_count_low += fp_acc_data->intra_count_low;
-  this_tile->fp_data.intra_count_high += fp_acc_data->intra_count_high;
-  this_tile->fp_data.intra_skip_count += fp_acc_data->intra_skip_count;
-  this_tile->fp_data.mvcount += fp_acc_data->mvcount;
-  this_tile->fp_data.sum_mvr += fp_acc_data->sum_mvr;
-  this_tile->fp_data.sum_mvr_abs += fp_acc_data->sum_mvr_abs;
-  this_tile->fp_data.sum_mvc += fp_acc_data->sum_mvc;
-  this_tile->fp_data.sum_mvc_abs += fp_acc_data->sum_mvc_abs;
-  this_tile->fp_data.sum_mvrs += fp_acc_data->sum_mvrs;
-  this_tile->fp_data.sum_mvcs += fp_acc_data->sum_mvcs;
-  this_tile->fp_data.sum_in_vectors += fp_acc_data->sum_in_vectors;
-  this_tile->fp_data.intra_smooth_count += fp_acc_data->intra_smooth_count;
-  this_tile->fp_data.image_data_start_row =
-      VPXMIN(this_tile->fp_data.image_data_start_row,
+// Merges the partial sums of one mb row into an accumulator. Rows are always
+// merged in increasing row order, both by the single threaded first pass and
+// by the row based multi-threaded one (the last mb of a row is only reached
+// once the row above it has completed), so the floating point sums do not
+// depend on the number of threads.
+static void accumulate_fp_mb_row_stat(FIRSTPASS_DATA *acc_data,
+                                      const FIRSTPASS_DATA *fp_acc_data) {
+  acc_data->intra_factor += fp_acc_data->intra_factor;
+  acc_data->brightness_factor += fp_acc_data->brightness_factor;
+  acc_data->coded_error += fp_acc_data->coded_error;
+  acc_data->sr_coded_error += fp_acc_data->sr_coded_error;
+  acc_data->frame_noise_energy += fp_acc_data->frame_noise_energy;
+  acc_data->intra_error += fp_acc_data->intra_error;
+  acc_data->intercount += fp_acc_data->intercount;
+  acc_data->second_ref_count += fp_acc_data->second_ref_count;
+  acc_data->neutral_count += fp_acc_data->neutral_count;
+  acc_data->intra_count_low += fp_acc_data->intra_count_low;
+  acc_data->intra_count_high += fp_acc_data->intra_count_high;
+  acc_data->intra_skip_count += fp_acc_data->intra_skip_count;
+  acc_data->mvcount += fp_acc_data->mvcount;
+  acc_data->sum_mvr += fp_acc_data->sum_mvr;
+  acc_data->sum_mvr_abs += fp_acc_data->sum_mvr_abs;
+  acc_data->sum_mvc += fp_acc_data->sum_mvc;
+  acc_data->sum_mvc_abs += fp_acc_data->sum_mvc_abs;
+  acc_data->sum_mvrs += fp_acc_data->sum_mvrs;
+  acc_data->sum_mvcs += fp_acc_data->sum_mvcs;
+  acc_data->sum_in_vectors += fp_acc_data->sum_in_vectors;
+  acc_data->intra_smooth_count += fp_acc_data->intra_smooth_count;
+  acc_data->image_data_start_row =
+      VPXMIN(acc_data->image_data_start_row,
              fp_acc_data->image_data_start_row) == INVALID_ROW
-          ? VPXMAX(this_tile->fp_data.image_data_start_row,
+          ? VPXMAX(acc_data->image_data_start_row,
                    fp_acc_data->image_data_start_row)
-          : VPXMIN(this_tile->fp_data.image_data_start_row,
+          : VPXMIN(acc_data->image_data_start_row,
                    fp_acc_data->image_data_start_row);
 }
 
@@ -878,7 +858,6 @@ void vp9_first_pass_encode_tile_mb_row(VP9_COMP *cpi, ThreadData *td,
     const BLOCK_SIZE bsize = get_bsize(cm, mb_row, mb_col);
     double log_intra;
     int level_sample;
-    const int mb_index = mb_row * cm->mb_cols + mb_col;
 
 #if CONFIG_FP_MB_STATS
     const int mb_index = mb_row * cm->mb_cols + mb_col;
@@ -979,13 +958,8 @@ void vp9_first_pass_encode_tile_mb_row(VP9_COMP *cpi, ThreadData *td,
     if (log_intra < 10.0) {
       mb_intra_factor = 1.0 + ((10.0 - log_intra) * 0.05);
       fp_acc_data->intra_factor += mb_intra_factor;
-      if (cpi->oxcf.row_mt_bit_exact)
-        cpi->twopass.fp_mb_float_stats[mb_index].frame_mb_intra_factor =
-            mb_intra_factor;
     } else {
       fp_acc_data->intra_factor += 1.0;
-      if (cpi->oxcf.row_mt_bit_exact)
-        cpi->twopass.fp_mb_float_stats[mb_index].frame_mb_intra_factor = 1.0;
     }
 
 #if CONFIG_VP9_HIGHBITDEPTH
@@ -999,14 +973,8 @@ void vp9_first_pass_encode_tile_mb_row(VP9_COMP *cpi, ThreadData *td,
     if ((level_sample < DARK_THRESH) && (log_intra < 9.0)) {
       mb_brightness_factor = 1.0 + (0.01 * (DARK_THRESH - level_sample));
       fp_acc_data->brightness_factor += mb_brightness_factor;
-      if (cpi->oxcf.row_mt_bit_exact)
-        cpi->twopass.fp_mb_float_stats[mb_index].frame_mb_brightness_factor =
-            mb_brightness_factor;
     } else {
       fp_acc_data->brightness_factor += 1.0;
-      if (cpi->oxcf.row_mt_bit_exact)
-        cpi->twopass.fp_mb_float_stats[mb_index].frame_mb_brightness_factor =
-            1.0;
     }
 
     // Intrapenalty below deals with situations where the intra and inter
@@ -1166,9 +1134,6 @@ void vp9_first_pass_encode_tile_mb_row(VP9_COMP *cpi, ThreadData *td,
         if (((this_error - intrapenalty) * 9 <= motion_error * 10) &&
             (this_error < (2 * intrapenalty))) {
           fp_acc_data->neutral_count += 1.0;
-          if (cpi->oxcf.row_mt_bit_exact)
-            cpi->twopass.fp_mb_float_stats[mb_index].frame_mb_neutral_count =
-                1.0;
           // Also track cases where the intra is not much worse than the inter
           // and use this in limiting the GF/arf group length.
         } else if ((this_error > NCOUNT_INTRA_THRESH) &&
@@ -1176,9 +1141,6 @@ void vp9_first_pass_encode_tile_mb_row(VP9_COMP *cpi, ThreadData *td,
           mb_neutral_count =
               (double)motion_error / DOUBLE_DIVIDE_CHECK((double)this_error);
           fp_acc_data->neutral_count += mb_neutral_count;
-          if (cpi->oxcf.row_mt_bit_exact)
-            cpi->twopass.fp_mb_float_stats[mb_index].frame_mb_neutral_count =
-                mb_neutral_count;
         }
 
         mv.row *= 8;
@@ -1298,7 +1260,7 @@ void vp9_first_pass_encode_tile_mb_row(VP9_COMP *cpi, ThreadData *td,
 
     // Accumulate row level stats to the corresponding tile stats
     if (cpi->row_mt && mb_col == (tile.mi_col_end >> 1) - 1)
-      accumulate_fp_mb_row_stat(tile_data, fp_acc_data);
+      accumulate_fp_mb_row_stat(&tile_data->fp_data, fp_acc_data);
 
     (*(cpi->row_mt_sync_write_ptr))(&tile_data->row_mt_sync, mb_row, c,
                                     num_mb_cols);
@@ -1317,9 +1279,15 @@ static void first_pass_encode(VP9_COMP *cpi, FIRSTPASS_DATA *fp_acc_data) {
   vp9_tile_init(tile, cm, 0, 0);
 
   for (mb_row = 0; mb_row < cm->mb_rows; ++mb_row) {
+    // Accumulate each row separately and merge it in row order, the same way
+    // the row based multi-threaded first pass does.
+    FIRSTPASS_DATA fp_row_data;
+    vp9_zero(fp_row_data);
+    fp_row_data.image_data_start_row = INVALID_ROW;
     best_ref_mv = zero_mv;
-    vp9_first_pass_encode_tile_mb_row(cpi, &cpi->td, fp_acc_data, &tile_data,
+    vp9_first_pass_encode_tile_mb_row(cpi, &cpi->td, &fp_row_data, &tile_data,
                                       &best_ref_mv, mb_row);
+    accumulate_fp_mb_row_stat(fp_acc_data, &fp_row_data);
   }
 }
 
@@ -1424,11 +1392,6 @@ void vp9_first_pass(VP9_COMP *cpi, const struct lookahead_entry *source) {
 
   cm->log2_tile_rows = 0;
 
-  if (cpi->oxcf.row_mt_bit_exact && cpi->twopass.fp_mb_float_stats == NULL)
-    CHECK_MEM_ERROR(
-        cm, cpi->twopass.fp_mb_float_stats,
-        vpx_calloc(cm->MBs * sizeof(*cpi->twopass.fp_mb_float_stats), 1));
-
   {
     FIRSTPASS_STATS fps;
     TileDataEnc *first_tile_col;
@@ -1441,14 +1404,12 @@ void vp9_first_pass(VP9_COMP *cpi, const struct lookahead_entry *source) {
     } else {
       cpi->row_mt_sync_read_ptr = vp9_row_mt_sync_read;
       cpi->row_mt_sync_write_ptr = vp9_row_mt_sync_write;
-      if (cpi->oxcf.row_mt_bit_exact) {
-        cm->log2_tile_cols = 0;
-        vp9_zero_array(cpi->twopass.fp_mb_float_stats, cm->MBs);
-      }
+      // The per row partial sums are merged in row order (see
+      // accumulate_fp_mb_row_stat()), so with a single tile column the stats
+      // match the single threaded first pass exactly.
+      if (cpi->oxcf.row_mt_bit_exact) cm->log2_tile_cols = 0;
       vp9_encode_fp_row_mt(cpi);
       first_tile_col = &cpi->tile_data[0];
-      if (cpi->oxcf.row_mt_bit_exact)
-        accumulate_floating_point_stats(cpi, first_tile_col);
       first_pass_stat_calc(cpi, &fps, &(first_tile_col->fp_data));
     }
 
@@ -1632,6 +1593,77 @@ void calculate_coded_size(VP9_COMP *cpi, int *scaled_frame_width,
   *scaled_frame_height = rc->frame_height[rc->frame_size_selector];
 }
 
+// A first pass over a single stream ends with one end of stream (EOS) packet
+// holding the stream totals. The first pass may instead be run independently
+// over chunks of the stream that each start with a key frame; their stats are
+// stitched by concatenating the per frame packets of all chunks in order,
+// followed by the EOS packet of each chunk in the same order. Since every EOS
+// packet counts at least one frame, the number of trailing EOS packets is the
+// smallest n for which they account for all the preceding packets. Returns 0
+// if the buffer has no such tail.
+int vp9_count_stats_eos_packets(const FIRSTPASS_STATS *stats, int packets) {
+  double frames = 0.0;
+  int eos;
+
+  for (eos = 1; eos < packets; ++eos) {
+    if (stats[packets - eos].count < 1.0) break;
+    frames += stats[packets - eos].count;
+    if ((int)(frames + 0.5) == packets - eos) return eos;
+  }
+  return 0;
+}
+
+// Sets the modified error clamps from the averages in total_stats and returns
+// the sum of the modified error of the frames in [start, end).
+static double init_modified_err(const VP9_COMP *cpi, TWO_PASS *twopass,
+                                const FIRSTPASS_STATS *start,
+                                const FIRSTPASS_STATS *end) {
+  const VP9EncoderConfig *const oxcf = &cpi->oxcf;
+  const FIRSTPASS_STATS *const stats = &twopass->total_stats;
+  const double avg_error =
+      stats->coded_error / DOUBLE_DIVIDE_CHECK(stats->count);
+  const FIRSTPASS_STATS *s = start;
+  double modified_error_total = 0.0;
+  twopass->modified_error_min =
+      (avg_error * oxcf->two_pass_vbrmin_section) / 100;
+  twopass->modified_error_max =
+      (avg_error * oxcf->two_pass_vbrmax_section) / 100;
+  while (s < end) {
+    modified_error_total += calculate_modified_err(cpi, twopass, oxcf, s);
+    ++s;
+  }
+  return modified_error_total;
+}
+
+// Restricts the second pass to one stitched chunk. The chunk's share of the
+// stream budget is its share of the modified error of the whole stream, so
+// chunks encoded separately still distribute the bits the way a single
+// second pass would. Within the chunk, bits are then allocated as if it were
+// a stream of its own.
+static void select_stats_chunk(VP9_COMP *cpi, TWO_PASS *twopass, int chunk) {
+  const FIRSTPASS_STATS *const eos = &twopass->stats_in_eos[chunk];
+  const FIRSTPASS_STATS *start = twopass->stats_in_start;
+  const FIRSTPASS_STATS *end;
+  double chunk_error;
+  int i;
+
+  for (i = 0; i < chunk; ++i)
+    start += (int)(twopass->stats_in_eos[i].count + 0.5);
+  end = start + (int)(eos->count + 0.5);
+
+  chunk_error = init_modified_err(cpi, twopass, start, end);
+  twopass->budget_duration =
+      twopass->total_stats.duration * chunk_error /
+      DOUBLE_DIVIDE_CHECK(twopass->modified_error_left);
+
+  twopass->stats_in_start = start;
+  twopass->stats_in = start;
+  twopass->stats_in_end = end;
+  twopass->total_stats = *eos;
+  twopass->total_left_stats = *eos;
+  twopass->modified_error_left = init_modified_err(cpi, twopass, start, end);
+}
+
 void vp9_init_second_pass(VP9_COMP *cpi) {
   SVC *const svc = &cpi->svc;
   const VP9EncoderConfig *const oxcf = &cpi->oxcf;
@@ -1651,8 +1683,19 @@ void vp9_init_second_pass(VP9_COMP *cpi) {
 
   stats = &twopass->total_stats;
 
-  *stats = *twopass->stats_in_end;
+  if (twopass->stats_in_eos != NULL) {
+    // Start from the whole stream; a chunk may have been selected before.
+    int i;
+    twopass->stats_in_start = oxcf->two_pass_stats_in.buf;
+    twopass->stats_in = twopass->stats_in_start;
+    twopass->stats_in_end = twopass->stats_in_eos;
+    for (i = 0; i < twopass->num_chunks; ++i)
+      accumulate_stats(stats, &twopass->stats_in_eos[i]);
+  } else {
+    *stats = *twopass->stats_in_end;
+  }
   twopass->total_left_stats = *stats;
+  twopass->budget_duration = stats->duration;
 
   frame_rate = 10000000.0 * stats->count / stats->duration;
   // Each frame can have a different duration, as the frame rate in the source
@@ -1663,14 +1706,8 @@ void vp9_init_second_pass(VP9_COMP *cpi) {
 
   if (is_two_pass_svc) {
     vp9_update_spatial_layer_framerate(cpi, frame_rate);
-    twopass->bits_left =
-        (int64_t)(stats->duration *
-                  svc->layer_context[svc->spatial_layer_id].target_bandwidth /
-                  10000000.0);
   } else {
     vp9_new_framerate(cpi, frame_rate);
-    twopass->bits_left =
-        (int64_t)(stats->duration * oxcf->target_bandwidth / 10000000.0);
   }
 
   // This variable monitors how far behind the second ref update is lagging.
@@ -1678,20 +1715,21 @@ void vp9_init_second_pass(VP9_COMP *cpi) {
 
   // Scan the first pass file and calculate a modified total error based upon
   // the bias/power function used to allocate bits.
-  {
-    const double avg_error =
-        stats->coded_error / DOUBLE_DIVIDE_CHECK(stats->count);
-    const FIRSTPASS_STATS *s = twopass->stats_in;
-    double modified_error_total = 0.0;
-    twopass->modified_error_min =
-        (avg_error * oxcf->two_pass_vbrmin_section) / 100;
-    twopass->modified_error_max =
-        (avg_error * oxcf->two_pass_vbrmax_section) / 100;
-    while (s < twopass->stats_in_end) {
-      modified_error_total += calculate_modified_err(cpi, twopass, oxcf, s);
-      ++s;
-    }
-    twopass->modified_error_left = modified_error_total;
+  twopass->modified_error_left =
+      init_modified_err(cpi, twopass, twopass->stats_in, twopass->stats_in_end);
+
+  if (!is_two_pass_svc && oxcf->two_pass_chunk >= 0 &&
+      oxcf->two_pass_chunk < twopass->num_chunks)
+    select_stats_chunk(cpi, twopass, oxcf->two_pass_chunk);
+
+  if (is_two_pass_svc) {
+    twopass->bits_left =
+        (int64_t)(twopass->budget_duration *
+                  svc->layer_context[svc->spatial_layer_id].target_bandwidth /
+                  10000000.0);
+  } else {
+    twopass->bits_left = (int64_t)(twopass->budget_duration *
+                                   oxcf->target_bandwidth / 10000000.0);
   }
 
   // Reset the vbr bits off target counters
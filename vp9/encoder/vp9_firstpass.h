@@ -41,12 +41,6 @@ typedef struct {
 
 #define INVALID_ROW -1
 
-typedef struct {
-  double frame_mb_intra_factor;
-  double frame_mb_brightness_factor;
-  double frame_mb_neutral_count;
-} FP_MB_FLOAT_STATS;
-
 typedef struct {
   double intra_factor;
   double brightness_factor;
@@ -135,9 +129,16 @@ typedef struct {
   const FIRSTPASS_STATS *stats_in;
   const FIRSTPASS_STATS *stats_in_start;
   const FIRSTPASS_STATS *stats_in_end;
+  // End of stream packets, one per stitched first pass chunk.
+  const FIRSTPASS_STATS *stats_in_eos;
+  int num_chunks;
   FIRSTPASS_STATS total_left_stats;
   int first_pass_done;
   int64_t bits_left;
+  // Duration (in 1/10000000 s) over which the target bandwidth is spent to
+  // give the budget of this encode. Less than the duration of the stream
+  // when a single chunk is encoded.
+  double budget_duration;
   double modified_error_min;
   double modified_error_max;
   double modified_error_left;
@@ -150,8 +151,6 @@ typedef struct {
   FIRSTPASS_MB_STATS firstpass_mb_stats;
 #endif
 
-  FP_MB_FLOAT_STATS *fp_mb_float_stats;
-
   // An indication of the content type of the current frame
   FRAME_CONTENT_TYPE fr_content_type;
 
@@ -193,6 +192,7 @@ void vp9_first_pass_encode_tile_mb_row(struct VP9_COMP *cpi,
                                        struct TileDataEnc *tile_data,
                                        MV *best_ref_mv, int mb_row);
 
+int vp9_count_stats_eos_packets(const FIRSTPASS_STATS *stats, int packets);
 void vp9_init_second_pass(struct VP9_COMP *cpi);
 void vp9_rc_get_second_pass_params(struct VP9_COMP *cpi);
 void vp9_twopass_postencode_update(struct VP9_COMP *cpi);
@@ -45,11 +45,10 @@ static const int pos_shift_16x16[4][4] = {
   { 9, 10, 13, 14 }, { 11, 12, 15, 16 }, { 17, 18, 21, 22 }, { 19, 20, 23, 24 }
 };
 
-static int mv_refs_rt(VP9_COMP *cpi, const VP9_COMMON *cm, const MACROBLOCK *x,
+static int mv_refs_rt(const VP9_COMMON *cm, const MACROBLOCK *x,
                       const MACROBLOCKD *xd, const TileInfo *const tile,
                       MODE_INFO *mi, MV_REFERENCE_FRAME ref_frame,
-                      int_mv *mv_ref_list, int_mv *base_mv, int mi_row,
-                      int mi_col, int use_base_mv) {
+                      int_mv *mv_ref_list, int mi_row, int mi_col) {
   const int *ref_sign_bias = cm->ref_frame_sign_bias;
   int i, refmv_count = 0;
 
@@ -113,22 +112,6 @@ static int mv_refs_rt(VP9_COMP *cpi, const VP9_COMMON *cm, const MACROBLOCK *x,
       }
     }
   }
-  if (use_base_mv &&
-      !cpi->svc.layer_context[cpi->svc.temporal_layer_id].is_key_frame &&
-      ref_frame == LAST_FRAME) {
-    // Get base layer mv.
-    MV_REF *candidate =
-        &cm->prev_frame
-             ->mvs[(mi_col >> 1) + (mi_row >> 1) * (cm->mi_cols >> 1)];
-    if (candidate->mv[0].as_int != INVALID_MV) {
-      base_mv->as_mv.row = (candidate->mv[0].as_mv.row * 2);
-      base_mv->as_mv.col = (candidate->mv[0].as_mv.col * 2);
-      clamp_mv_ref(&base_mv->as_mv, xd);
-    } else {
-      base_mv->as_int = INVALID_MV;
-    }
-  }
-
 Done:
 
   x->mbmi_ext->mode_context[ref_frame] = counter_to_context[context_counter];
@@ -147,7 +130,7 @@ static int combined_motion_search(VP9_COMP *cpi, MACROBLOCK *x,
   MACROBLOCKD *xd = &x->e_mbd;
   MODE_INFO *mi = xd->mi[0];
   struct buf_2d backup_yv12[MAX_MB_PLANE] = { { 0, 0 } };
-  const int step_param = cpi->sf.mv.fullpel_search_step_param;
+  int step_param = cpi->sf.mv.fullpel_search_step_param;
   const int sadpb = x->sadperbit16;
   MV mvp_full;
   const int ref = mi->ref_frame[0];
@@ -170,12 +153,21 @@ static int combined_motion_search(VP9_COMP *cpi, MACROBLOCK *x,
   }
   vp9_set_mv_search_range(&x->mv_limits, &ref_mv);
 
-  assert(x->mv_best_ref_index[ref] <= 2);
+  assert(x->mv_best_ref_index[ref] <= TEMPORAL_MV_REF_INDEX);
   if (x->mv_best_ref_index[ref] < 2)
     mvp_full = x->mbmi_ext->ref_mvs[ref][x->mv_best_ref_index[ref]].as_mv;
+  else if (x->mv_best_ref_index[ref] == TEMPORAL_MV_REF_INDEX)
+    mvp_full = x->temporal_mv[ref];
   else
     mvp_full = x->pred_mv[ref];
 
+  // The scaled motion of the lower resolution frame is only off by the
+  // rounding of the down-sampling, so a local search around it suffices.
+  if (use_base_mv) {
+    mvp_full = tmp_mv->as_mv;
+    step_param = VPXMAX(step_param, MAX_MVSEARCH_STEPS - 3);
+  }
+
   mvp_full.col >>= 3;
   mvp_full.row >>= 3;
 
@@ -206,7 +198,7 @@ static int combined_motion_search(VP9_COMP *cpi, MACROBLOCK *x,
     const int subpel_force_stop = use_base_mv && cpi->sf.base_mv_aggressive
                                       ? 2
                                       : cpi->sf.mv.subpel_force_stop;
-    cpi->find_fractional_mv_step(
+    get_fractional_mv_step(cpi, x)(
         x, &tmp_mv->as_mv, &ref_mv, cpi->common.allow_high_precision_mv,
         x->errorperbit, &cpi->fn_ptr[bsize], subpel_force_stop,
         cpi->sf.mv.subpel_iters_per_step, cond_cost_list(cpi, cost_list),
@@ -222,6 +214,65 @@ static int combined_motion_search(VP9_COMP *cpi, MACROBLOCK *x,
   return rv;
 }
 
+// Returns in |base_mv| the LAST_FRAME motion vector of the block co-located
+// with the center of the current block in the lower resolution frame coded
+// just before this one, scaled to the current resolution, or INVALID_MV. The
+// lower resolution frame is the lower spatial layer of the superframe in SVC,
+// or the frame of the lower resolution encoder in multi-resolution encoding.
+// With mode hints, the motion vector of the hint at the center is used as is.
+static void get_base_mv(const VP9_COMP *cpi, const MACROBLOCKD *xd, int mi_row,
+                        int mi_col, BLOCK_SIZE bsize, int_mv *base_mv) {
+  const VP9_COMMON *const cm = &cpi->common;
+  const int row = VPXMIN(mi_row + (num_8x8_blocks_high_lookup[bsize] >> 1),
+                         cm->mi_rows - 1);
+  const int col = VPXMIN(mi_col + (num_8x8_blocks_wide_lookup[bsize] >> 1),
+                         cm->mi_cols - 1);
+  int low_width, low_height, low_mi_rows, low_mi_cols;
+  int_mv mv;
+
+  if (cpi->mode_hints.enabled) {
+    *base_mv = cpi->mode_hints.hints[row * cm->mi_cols + col].mv;
+    if (base_mv->as_int != INVALID_MV) clamp_mv_ref(&base_mv->as_mv, xd);
+    return;
+  }
+
+#if CONFIG_MULTI_RES_ENCODING
+  if (cpi->mr_low_res_mv_avail) {
+    const LOWER_RES_FRAME_INFO *const info = cpi->oxcf.mr_low_res_frame_info;
+    low_width = info->width;
+    low_height = info->height;
+    low_mi_rows = info->mi_rows;
+    low_mi_cols = info->mi_cols;
+    mv = info->mvs[VPXMIN(row * low_height / cm->height, low_mi_rows - 1) *
+                       low_mi_cols +
+                   VPXMIN(col * low_width / cm->width, low_mi_cols - 1)];
+  } else
+#endif
+  {
+    const RefCntBuffer *const prev = cm->prev_frame;
+    const MV_REF *candidate;
+    low_width = prev->buf.y_crop_width;
+    low_height = prev->buf.y_crop_height;
+    low_mi_rows = (low_height + MI_SIZE - 1) >> MI_SIZE_LOG2;
+    low_mi_cols = (low_width + MI_SIZE - 1) >> MI_SIZE_LOG2;
+    candidate =
+        &prev->mvs[VPXMIN(row * low_height / cm->height, low_mi_rows - 1) *
+                       low_mi_cols +
+                   VPXMIN(col * low_width / cm->width, low_mi_cols - 1)];
+    mv.as_int =
+        candidate->ref_frame[0] == LAST_FRAME ? candidate->mv[0].as_int
+                                              : INVALID_MV;
+  }
+
+  if (mv.as_int == INVALID_MV) {
+    base_mv->as_int = INVALID_MV;
+    return;
+  }
+  base_mv->as_mv.row = (int16_t)(mv.as_mv.row * cm->height / low_height);
+  base_mv->as_mv.col = (int16_t)(mv.as_mv.col * cm->width / low_width);
+  clamp_mv_ref(&base_mv->as_mv, xd);
+}
+
 static void block_variance(const uint8_t *src, int src_stride,
                            const uint8_t *ref, int ref_stride, int w, int h,
                            unsigned int *sse, int *sum, int block_size,
@@ -1176,7 +1227,7 @@ static INLINE void find_predictors(
     int const_motion[MAX_REF_FRAMES], int *ref_frame_skip_mask,
     const int flag_list[4], TileDataEnc *tile_data, int mi_row, int mi_col,
     struct buf_2d yv12_mb[4][MAX_MB_PLANE], BLOCK_SIZE bsize,
-    int force_skip_low_temp_var) {
+    int force_skip_low_temp_var, int use_base_mv) {
   VP9_COMMON *const cm = &cpi->common;
   MACROBLOCKD *const xd = &x->e_mbd;
   const YV12_BUFFER_CONFIG *yv12 = get_ref_frame_buffer(cpi, ref_frame);
@@ -1194,14 +1245,14 @@ static INLINE void find_predictors(
       vp9_find_mv_refs(cm, xd, xd->mi[0], ref_frame, candidates, mi_row, mi_col,
                        x->mbmi_ext->mode_context);
     } else {
-      const_motion[ref_frame] =
-          mv_refs_rt(cpi, cm, x, xd, tile_info, xd->mi[0], ref_frame,
-                     candidates, &frame_mv[NEWMV][ref_frame], mi_row, mi_col,
-                     (int)(cpi->svc.use_base_mv && cpi->svc.spatial_layer_id));
+      const_motion[ref_frame] = mv_refs_rt(cm, x, xd, tile_info, xd->mi[0],
+                                           ref_frame, candidates, mi_row, mi_col);
     }
     vp9_find_best_ref_mvs(xd, cm->allow_high_precision_mv, candidates,
                           &frame_mv[NEARESTMV][ref_frame],
                           &frame_mv[NEARMV][ref_frame]);
+    if (use_base_mv && ref_frame == LAST_FRAME)
+      get_base_mv(cpi, xd, mi_row, mi_col, bsize, &frame_mv[NEWMV][ref_frame]);
     // Early exit for golden frame if force_skip_low_temp_var is set.
     if (!vp9_is_scaled(sf) && bsize >= BLOCK_8X8 &&
         !(force_skip_low_temp_var && ref_frame == GOLDEN_FRAME)) {
@@ -1465,6 +1516,7 @@ void vp9_pick_inter_mode(VP9_COMP *cpi, MACROBLOCK *x, TileDataEnc *tile_data,
   int use_golden_nonzeromv = 1;
   int force_skip_low_temp_var = 0;
   int skip_ref_find_pred[4] = { 0 };
+  const int use_base_mv = base_mv_avail(cpi);
 #if CONFIG_VP9_TEMPORAL_DENOISING
   VP9_PICKMODE_CTX_DEN ctx_den;
   int64_t zero_last_cost_orig = INT64_MAX;
@@ -1604,7 +1656,8 @@ void vp9_pick_inter_mode(VP9_COMP *cpi, MACROBLOCK *x, TileDataEnc *tile_data,
     if (!skip_ref_find_pred[ref_frame]) {
       find_predictors(cpi, x, ref_frame, frame_mv, const_motion,
                       &ref_frame_skip_mask, flag_list, tile_data, mi_row,
-                      mi_col, yv12_mb, bsize, force_skip_low_temp_var);
+                      mi_col, yv12_mb, bsize, force_skip_low_temp_var,
+                      use_base_mv);
     }
   }
 
@@ -1756,7 +1809,7 @@ void vp9_pick_inter_mode(VP9_COMP *cpi, MACROBLOCK *x, TileDataEnc *tile_data,
         frame_mv[NEWMV][ref_frame].as_mv.row >>= 3;
         frame_mv[NEWMV][ref_frame].as_mv.col >>= 3;
 
-        cpi->find_fractional_mv_step(
+        get_fractional_mv_step(cpi, x)(
             x, &frame_mv[NEWMV][ref_frame].as_mv,
             &x->mbmi_ext->ref_mvs[ref_frame][0].as_mv,
             cpi->common.allow_high_precision_mv, x->errorperbit,
@@ -1764,7 +1817,7 @@ void vp9_pick_inter_mode(VP9_COMP *cpi, MACROBLOCK *x, TileDataEnc *tile_data,
             cpi->sf.mv.subpel_iters_per_step, cond_cost_list(cpi, cost_list),
             x->nmvjointcost, x->mvcost, &dis, &x->pred_sse[ref_frame], NULL, 0,
             0);
-      } else if (svc->use_base_mv && svc->spatial_layer_id) {
+      } else if (use_base_mv) {
         if (frame_mv[NEWMV][ref_frame].as_int != INVALID_MV) {
           const int pre_stride = xd->plane[0].pre[0].stride;
           int base_mv_sad = INT_MAX;
@@ -2398,7 +2451,7 @@ void vp9_pick_inter_mode_sub8x8(VP9_COMP *cpi, MACROBLOCK *x, int mi_row,
                                           [INTER_OFFSET(NEWMV)];
             if (RDCOST(x->rdmult, x->rddiv, b_rate, 0) > b_best_rd) continue;
 
-            cpi->find_fractional_mv_step(
+            get_fractional_mv_step(cpi, x)(
                 x, &tmp_mv, &mbmi_ext->ref_mvs[ref_frame][0].as_mv,
                 cpi->common.allow_high_precision_mv, x->errorperbit,
                 &cpi->fn_ptr[bsize], cpi->sf.mv.subpel_force_stop,
@@ -11,6 +11,7 @@
 #include <assert.h>
 #include <math.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "./vp9_rtcd.h"
 
@@ -65,29 +66,49 @@ static const uint8_t rd_thresh_block_size_factor[BLOCK_SIZES] = {
   2, 3, 3, 4, 6, 6, 8, 12, 12, 16, 24, 24, 32
 };
 
+// Rebuilds the costs of the tokens of a tree if its probabilities differ from
+// the ones the costs were last built from.
+static void update_cost_tokens(int *costs, vpx_prob *last_probs,
+                               const vpx_prob *probs, int num_probs,
+                               vpx_tree tree) {
+  if (!memcmp(last_probs, probs, num_probs)) return;
+  vp9_cost_tokens(costs, probs, tree);
+  memcpy(last_probs, probs, num_probs);
+}
+
 static void fill_mode_costs(VP9_COMP *cpi) {
   const FRAME_CONTEXT *const fc = cpi->common.fc;
+  RD_COST_CACHE *const cache = &cpi->rd.cost_cache;
   int i, j;
 
   for (i = 0; i < INTRA_MODES; ++i)
     for (j = 0; j < INTRA_MODES; ++j)
-      vp9_cost_tokens(cpi->y_mode_costs[i][j], vp9_kf_y_mode_prob[i][j],
-                      vp9_intra_mode_tree);
+      update_cost_tokens(cpi->y_mode_costs[i][j], cache->kf_y_mode_prob[i][j],
+                         vp9_kf_y_mode_prob[i][j], INTRA_MODES - 1,
+                         vp9_intra_mode_tree);
 
-  vp9_cost_tokens(cpi->mbmode_cost, fc->y_mode_prob[1], vp9_intra_mode_tree);
+  update_cost_tokens(cpi->mbmode_cost, cache->y_mode_prob, fc->y_mode_prob[1],
+                     INTRA_MODES - 1, vp9_intra_mode_tree);
   for (i = 0; i < INTRA_MODES; ++i) {
-    vp9_cost_tokens(cpi->intra_uv_mode_cost[KEY_FRAME][i],
-                    vp9_kf_uv_mode_prob[i], vp9_intra_mode_tree);
-    vp9_cost_tokens(cpi->intra_uv_mode_cost[INTER_FRAME][i],
-                    fc->uv_mode_prob[i], vp9_intra_mode_tree);
+    update_cost_tokens(cpi->intra_uv_mode_cost[KEY_FRAME][i],
+                       cache->uv_mode_prob[KEY_FRAME][i],
+                       vp9_kf_uv_mode_prob[i], INTRA_MODES - 1,
+                       vp9_intra_mode_tree);
+    update_cost_tokens(cpi->intra_uv_mode_cost[INTER_FRAME][i],
+                       cache->uv_mode_prob[INTER_FRAME][i],
+                       fc->uv_mode_prob[i], INTRA_MODES - 1,
+                       vp9_intra_mode_tree);
   }
 
   for (i = 0; i < SWITCHABLE_FILTER_CONTEXTS; ++i)
-    vp9_cost_tokens(cpi->switchable_interp_costs[i],
-                    fc->switchable_interp_prob[i], vp9_switchable_interp_tree);
+    update_cost_tokens(cpi->switchable_interp_costs[i],
+                       cache->switchable_interp_prob[i],
+                       fc->switchable_interp_prob[i], SWITCHABLE_FILTERS - 1,
+                       vp9_switchable_interp_tree);
 }
 
 static void fill_token_costs(vp9_coeff_cost *c,
+                             vp9_coeff_probs_model (*last_p)[PLANE_TYPES],
                              vp9_coeff_probs_model (*p)[PLANE_TYPES]) {
   int i, j, k, l;
   TX_SIZE t;
@@ -97,6 +118,11 @@ static void fill_token_costs(vp9_coeff_cost *c,
         for (k = 0; k < COEF_BANDS; ++k)
           for (l = 0; l < BAND_COEFF_CONTEXTS(k); ++l) {
             vpx_prob probs[ENTROPY_NODES];
+            if (!memcmp(last_p[t][i][j][k][l], p[t][i][j][k][l],
+                        UNCONSTRAINED_NODES))
+              continue;
+            memcpy(last_p[t][i][j][k][l], p[t][i][j][k][l],
+                   UNCONSTRAINED_NODES);
             vp9_model_to_full_probs(p[t][i][j][k][l], probs);
             vp9_cost_tokens((int *)c[t][i][j][k][0][l], probs, vp9_coef_tree);
             vp9_cost_tokens_skip((int *)c[t][i][j][k][1][l], probs,
@@ -224,6 +250,13 @@ void vp9_initialize_me_consts(VP9_COMP *cpi, MACROBLOCK *x, int qindex) {
 }
 
 static void set_block_thresholds(const VP9_COMMON *cm, RD_OPT *rd) {
+  // The thresholds of a segment only change with its q index and the
+  // multipliers, so they are kept when neither changed.
+  const int mult_changed =
+      !rd->threshes_valid ||
+      memcmp(rd->threshes_mult, rd->thresh_mult, sizeof(rd->thresh_mult)) ||
+      memcmp(rd->threshes_mult_sub8x8, rd->thresh_mult_sub8x8,
+             sizeof(rd->thresh_mult_sub8x8));
   int i, bsize, segment_id;
 
   for (segment_id = 0; segment_id < MAX_SEGMENTS; ++segment_id) {
@@ -231,7 +264,11 @@ static void set_block_thresholds(const VP9_COMMON *cm, RD_OPT *rd) {
         clamp(vp9_get_qindex(&cm->seg, segment_id, cm->base_qindex) +
                   cm->y_dc_delta_q,
               0, MAXQ);
-    const int q = compute_rd_thresh_factor(qindex, cm->bit_depth);
+    int q;
+
+    if (!mult_changed && rd->threshes_qindex[segment_id] == qindex) continue;
+    rd->threshes_qindex[segment_id] = qindex;
+    q = compute_rd_thresh_factor(qindex, cm->bit_depth);
 
     for (bsize = 0; bsize < BLOCK_SIZES; ++bsize) {
       // Threshold here seems unnecessarily harsh but fine given actual
@@ -253,6 +290,36 @@ static void set_block_thresholds(const VP9_COMMON *cm, RD_OPT *rd) {
       }
     }
   }
+
+  memcpy(rd->threshes_mult, rd->thresh_mult, sizeof(rd->thresh_mult));
+  memcpy(rd->threshes_mult_sub8x8, rd->thresh_mult_sub8x8,
+         sizeof(rd->thresh_mult_sub8x8));
+  rd->threshes_valid = 1;
+}
+
+static void fill_mv_costs(VP9_COMP *cpi) {
+  VP9_COMMON *const cm = &cpi->common;
+  MACROBLOCK *const x = &cpi->td.mb;
+  RD_COST_CACHE *const cache = &cpi->rd.cost_cache;
+  const nmv_context *const nmvc = &cm->fc->nmvc;
+  const int usehp = cm->allow_high_precision_mv;
+  int **const mvcost = usehp ? x->nmvcost_hp : x->nmvcost;
+  int i;
+
+  update_cost_tokens(x->nmvjointcost, cache->mv_joints, nmvc->joints,
+                     MV_JOINTS - 1, vp9_mv_joint_tree);
+  for (i = 0; i < 2; ++i) {
+    if (!memcmp(&cache->mv_comps[usehp][i], &nmvc->comps[i],
+                sizeof(nmvc->comps[i])))
+      continue;
+    vp9_build_nmv_component_cost_table(mvcost[i], &nmvc->comps[i], usehp);
+    cache->mv_comps[usehp][i] = nmvc->comps[i];
+  }
+}
+
+void vp9_invalidate_mv_costs(RD_OPT *rd) {
+  vp9_zero(rd->cost_cache.mv_joints);
+  vp9_zero(rd->cost_cache.mv_comps);
 }
 
 void vp9_initialize_rd_consts(VP9_COMP *cpi) {
@@ -277,21 +344,22 @@ void vp9_initialize_rd_consts(VP9_COMP *cpi) {
   set_block_thresholds(cm, rd);
   set_partition_probs(cm, xd);
 
+  // The cost tables are only rebuilt for the contexts whose probabilities
+  // changed since they were last built, see RD_COST_CACHE.
   if (cpi->oxcf.pass == 1) {
-    if (!frame_is_intra_only(cm))
-      vp9_build_nmv_cost_table(
-          x->nmvjointcost,
-          cm->allow_high_precision_mv ? x->nmvcost_hp : x->nmvcost,
-          &cm->fc->nmvc, cm->allow_high_precision_mv);
+    if (!frame_is_intra_only(cm)) fill_mv_costs(cpi);
   } else {
+    RD_COST_CACHE *const cache = &rd->cost_cache;
+
     if (!cpi->sf.use_nonrd_pick_mode || cm->frame_type == KEY_FRAME)
-      fill_token_costs(x->token_costs, cm->fc->coef_probs);
+      fill_token_costs(x->token_costs, cache->coef_probs, cm->fc->coef_probs);
 
     if (cpi->sf.partition_search_type != VAR_BASED_PARTITION ||
         cm->frame_type == KEY_FRAME) {
       for (i = 0; i < PARTITION_CONTEXTS; ++i)
-        vp9_cost_tokens(cpi->partition_cost[i], get_partition_probs(xd, i),
-                        vp9_partition_tree);
+        update_cost_tokens(cpi->partition_cost[i], cache->partition_prob[i],
+                           get_partition_probs(xd, i), PARTITION_TYPES - 1,
+                           vp9_partition_tree);
     }
 
     if (!cpi->sf.use_nonrd_pick_mode || (cm->current_video_frame & 0x07) == 1 ||
@@ -299,14 +367,13 @@ void vp9_initialize_rd_consts(VP9_COMP *cpi) {
       fill_mode_costs(cpi);
 
       if (!frame_is_intra_only(cm)) {
-        vp9_build_nmv_cost_table(
-            x->nmvjointcost,
-            cm->allow_high_precision_mv ? x->nmvcost_hp : x->nmvcost,
-            &cm->fc->nmvc, cm->allow_high_precision_mv);
+        fill_mv_costs(cpi);
 
         for (i = 0; i < INTER_MODE_CONTEXTS; ++i)
-          vp9_cost_tokens((int *)cpi->inter_mode_cost[i],
-                          cm->fc->inter_mode_probs[i], vp9_inter_mode_tree);
+          update_cost_tokens((int *)cpi->inter_mode_cost[i],
+                             cache->inter_mode_probs[i],
+                             cm->fc->inter_mode_probs[i], INTER_MODES - 1,
+                             vp9_inter_mode_tree);
       }
     }
   }
@@ -481,50 +548,108 @@ void vp9_get_entropy_contexts(BLOCK_SIZE bsize, TX_SIZE tx_size,
   }
 }
 
+static int16_t scale_temporal_mv(int v, int64_t dist, int64_t mv_dist) {
+  const int64_t scaled = v * dist / mv_dist;
+  return (int16_t)VPXMAX(VPXMIN(scaled, MV_UPP), MV_LOW);
+}
+
+// Gets the motion vector towards ref_frame of the block co-located with the
+// centre of the current block in earlier frames, scaled to the temporal
+// distance between ref_frame and the current frame.
+static int get_temporal_mv(const VP9_COMP *cpi, const MACROBLOCKD *xd,
+                           int ref_frame, BLOCK_SIZE block_size, MV *mv) {
+  const VP9_COMMON *const cm = &cpi->common;
+  const TemporalMvField *const field = &cpi->temporal_mv;
+  const int mi_row = -xd->mb_to_top_edge >> (3 + MI_SIZE_LOG2);
+  const int mi_col = -xd->mb_to_left_edge >> (3 + MI_SIZE_LOG2);
+  const int row = VPXMIN(mi_row + (num_8x8_blocks_high_lookup[block_size] >> 1),
+                         cm->mi_rows - 1);
+  const int col = VPXMIN(mi_col + (num_8x8_blocks_wide_lookup[block_size] >> 1),
+                         cm->mi_cols - 1);
+  const int buf_idx = get_ref_frame_buf_idx(cpi, ref_frame);
+  const TEMPORAL_MV *tmv;
+  int64_t dist;
+
+  if (field->rows != cm->mi_rows || field->cols != cm->mi_cols ||
+      buf_idx == INVALID_IDX)
+    return 0;
+
+  tmv = &field->mvs[ref_frame][row * cm->mi_cols + col];
+  dist = field->frame_ts - field->buf_ts[buf_idx];
+  if (tmv->dist == 0 || dist == 0) return 0;
+
+  mv->row = scale_temporal_mv(tmv->mv.as_mv.row, dist, tmv->dist);
+  mv->col = scale_temporal_mv(tmv->mv.as_mv.col, dist, tmv->dist);
+  clamp_mv_ref(mv, xd);
+  return 1;
+}
+
 void vp9_mv_pred(VP9_COMP *cpi, MACROBLOCK *x, uint8_t *ref_y_buffer,
                  int ref_y_stride, int ref_frame, BLOCK_SIZE block_size) {
   int i;
   int zero_seen = 0;
   int best_index = 0;
   int best_sad = INT_MAX;
-  int this_sad = INT_MAX;
   int max_mv = 0;
   int near_same_nearest;
+  int num_sads = 0;
+  int sad_index[4];
+  const uint8_t *ref_y_ptr[4];
+  unsigned int sads[4];
   uint8_t *src_y_ptr = x->plane[0].src.buf;
-  uint8_t *ref_y_ptr;
   const int num_mv_refs =
       MAX_MV_REF_CANDIDATES +
       (cpi->sf.adaptive_motion_search && block_size < x->max_partition_size);
+  const int use_temporal_mv =
+      cpi->sf.mv.use_temporal_mv &&
+      get_temporal_mv(cpi, &x->e_mbd, ref_frame, block_size,
+                      &x->temporal_mv[ref_frame]);
 
-  MV pred_mv[3];
+  MV pred_mv[4];
   pred_mv[0] = x->mbmi_ext->ref_mvs[ref_frame][0].as_mv;
   pred_mv[1] = x->mbmi_ext->ref_mvs[ref_frame][1].as_mv;
   pred_mv[2] = x->pred_mv[ref_frame];
-  assert(num_mv_refs <= (int)(sizeof(pred_mv) / sizeof(pred_mv[0])));
+  pred_mv[TEMPORAL_MV_REF_INDEX] = x->temporal_mv[ref_frame];
+  assert(num_mv_refs <= TEMPORAL_MV_REF_INDEX);
 
   near_same_nearest = x->mbmi_ext->ref_mvs[ref_frame][0].as_int ==
                       x->mbmi_ext->ref_mvs[ref_frame][1].as_int;
-  // Get the sad for each candidate reference mv.
-  for (i = 0; i < num_mv_refs; ++i) {
+  // Collect the distinct candidate reference mvs.
+  for (i = 0; i <= TEMPORAL_MV_REF_INDEX; ++i) {
     const MV *this_mv = &pred_mv[i];
     int fp_row, fp_col;
 
+    if (i == TEMPORAL_MV_REF_INDEX ? !use_temporal_mv : i >= num_mv_refs)
+      continue;
     if (i == 1 && near_same_nearest) continue;
     fp_row = (this_mv->row + 3 + (this_mv->row >= 0)) >> 3;
     fp_col = (this_mv->col + 3 + (this_mv->col >= 0)) >> 3;
-    max_mv = VPXMAX(max_mv, VPXMAX(abs(this_mv->row), abs(this_mv->col)) >> 3);
+    if (i != TEMPORAL_MV_REF_INDEX)
+      max_mv =
+          VPXMAX(max_mv, VPXMAX(abs(this_mv->row), abs(this_mv->col)) >> 3);
 
     if (fp_row == 0 && fp_col == 0 && zero_seen) continue;
     zero_seen |= (fp_row == 0 && fp_col == 0);
 
-    ref_y_ptr = &ref_y_buffer[ref_y_stride * fp_row + fp_col];
-    // Find sad for current vector.
-    this_sad = cpi->fn_ptr[block_size].sdf(src_y_ptr, x->plane[0].src.stride,
-                                           ref_y_ptr, ref_y_stride);
+    sad_index[num_sads] = i;
+    ref_y_ptr[num_sads++] = &ref_y_buffer[ref_y_stride * fp_row + fp_col];
+  }
+
+  // Find the sads of all candidates at once.
+  if (num_sads > 1) {
+    for (i = num_sads; i < 4; ++i) ref_y_ptr[i] = ref_y_ptr[0];
+    cpi->fn_ptr[block_size].sdx4df(src_y_ptr, x->plane[0].src.stride,
+                                   ref_y_ptr, ref_y_stride, sads);
+  } else {
+    sads[0] = cpi->fn_ptr[block_size].sdf(src_y_ptr, x->plane[0].src.stride,
+                                          ref_y_ptr[0], ref_y_stride);
+  }
+
+  for (i = 0; i < num_sads; ++i) {
     // Note if it is the best so far.
-    if (this_sad < best_sad) {
-      best_sad = this_sad;
-      best_index = i;
+    if ((int)sads[i] < best_sad) {
+      best_sad = sads[i];
+      best_index = sad_index[i];
     }
   }
 
@@ -95,6 +95,23 @@ typedef enum {
   THR_INTRA,
 } THR_MODES_SUB8X8;
 
+// The probabilities the rd cost tables were last built from. A table is only
+// rebuilt for the contexts whose probabilities changed since. Probabilities
+// are never 0, so a cleared entry forces the rebuild of its table.
+typedef struct RD_COST_CACHE {
+  vp9_coeff_probs_model coef_probs[TX_SIZES][PLANE_TYPES];
+  vpx_prob kf_y_mode_prob[INTRA_MODES][INTRA_MODES][INTRA_MODES - 1];
+  vpx_prob y_mode_prob[INTRA_MODES - 1];
+  vpx_prob uv_mode_prob[FRAME_TYPES][INTRA_MODES][INTRA_MODES - 1];
+  vpx_prob switchable_interp_prob[SWITCHABLE_FILTER_CONTEXTS]
+                                 [SWITCHABLE_FILTERS - 1];
+  vpx_prob partition_prob[PARTITION_CONTEXTS][PARTITION_TYPES - 1];
+  vpx_prob inter_mode_probs[INTER_MODE_CONTEXTS][INTER_MODES - 1];
+  vpx_prob mv_joints[MV_JOINTS - 1];
+  // Indexed by usehp, as the low and high precision tables are separate.
+  nmv_component mv_comps[2][2];
+} RD_COST_CACHE;
+
 typedef struct RD_OPT {
   // Thresh_mult is used to set a threshold for the rd score. A higher value
   // means that we will accept the best mode so far more often. This number
@@ -104,6 +121,12 @@ typedef struct RD_OPT {
   int thresh_mult_sub8x8[MAX_REFS];
 
   int threshes[MAX_SEGMENTS][BLOCK_SIZES][MAX_MODES];
+  // The q index of each segment and the multipliers the thresholds were
+  // last computed from.
+  int threshes_valid;
+  int threshes_qindex[MAX_SEGMENTS];
+  int threshes_mult[MAX_MODES];
+  int threshes_mult_sub8x8[MAX_REFS];
 
   int64_t prediction_type_threshes[MAX_REF_FRAMES][REFERENCE_MODES];
 
@@ -111,6 +134,8 @@ typedef struct RD_OPT {
 
   int RDMULT;
   int RDDIV;
+
+  RD_COST_CACHE cost_cache;
 } RD_OPT;
 
 typedef struct RD_COST {
@@ -136,6 +161,9 @@ int vp9_compute_rd_mult(const struct VP9_COMP *cpi, int qindex);
 
 void vp9_initialize_rd_consts(struct VP9_COMP *cpi);
 
+// Forces the rebuild of the mv cost tables, after they were overwritten.
+void vp9_invalidate_mv_costs(RD_OPT *rd);
+
 void vp9_initialize_me_consts(struct VP9_COMP *cpi, MACROBLOCK *x, int qindex);
 
 void vp9_model_rd_from_var_lapndz(unsigned int var, unsigned int n,
@@ -203,6 +231,10 @@ static INLINE void set_error_per_bit(MACROBLOCK *x, int rdmult) {
   x->errorperbit += (x->errorperbit == 0);
 }
 
+// Index of the co-located motion of earlier frames in the candidates of
+// vp9_mv_pred(), after the two reference mvs and x->pred_mv.
+#define TEMPORAL_MV_REF_INDEX 3
+
 void vp9_mv_pred(struct VP9_COMP *cpi, MACROBLOCK *x, uint8_t *ref_y_buffer,
                  int ref_y_stride, int ref_frame, BLOCK_SIZE block_size);
 
@@ -77,6 +77,35 @@ struct rdcost_block_args {
   uint8_t skippable;
 };
 
+// Modeled rd of the prediction of a block with one interpolation filter, as
+// produced by model_rd_for_sb().
+typedef struct {
+  int valid;
+  int rate_sum;
+  int64_t dist_sum;
+  int skip_sb;
+  int64_t skip_sse;
+  unsigned int pred_sse;
+  uint8_t skip_txfm[MAX_MB_PLANE << 2];
+  int64_t bsse[MAX_MB_PLANE << 2];
+} interp_model_rd;
+
+// Inter modes of a block that resolve to the same references and motion
+// vectors produce the same predictions, so the filter search results are
+// kept per (references, motion vectors) and reused across modes.
+typedef struct {
+  MV_REFERENCE_FRAME ref_frame[2];
+  int_mv mv[2];
+  interp_model_rd filter[SWITCHABLE_FILTERS];
+} interp_pred_cache_entry;
+
+#define INTERP_PRED_CACHE_SIZE 24
+
+typedef struct {
+  int num_entries;
+  interp_pred_cache_entry entry[INTERP_PRED_CACHE_SIZE];
+} interp_pred_cache;
+
 #define LAST_NEW_MV_INDEX 6
 static const MODE_DEFINITION vp9_mode_order[MAX_MODES] = {
   { NEARESTMV, { LAST_FRAME, NONE } },
@@ -534,6 +563,11 @@ static int64_t sum_squares_visible(const MACROBLOCKD *xd,
   return sse;
 }
 
+// Rounding error per pixel of the reconstruction of a block with non-zero
+// coefficients, in units of 1/32 of the squared pixel error, by transform size.
+// Fitted to the gap between pixel and transform domain distortion.
+static const int tx_domain_round_err[TX_SIZES] = { 0, 1, 2, 2 };
+
 static void dist_block(const VP9_COMP *cpi, MACROBLOCK *x, int plane,
                        BLOCK_SIZE plane_bsize, int block, int blk_row,
                        int blk_col, TX_SIZE tx_size, int64_t *out_dist,
@@ -542,7 +576,8 @@ static void dist_block(const VP9_COMP *cpi, MACROBLOCK *x, int plane,
   const struct macroblock_plane *const p = &x->plane[plane];
   const struct macroblockd_plane *const pd = &xd->plane[plane];
 
-  if (x->block_tx_domain) {
+  if (x->block_tx_domain ||
+      (cpi->sf.tx_domain_dist_model && is_inter_block(xd->mi[0]))) {
     const int ss_txfrm_size = tx_size << 1;
     int64_t this_sse;
     const int shift = tx_size == TX_32X32 ? 0 : 2;
@@ -560,6 +595,9 @@ static void dist_block(const VP9_COMP *cpi, MACROBLOCK *x, int plane,
 #endif  // CONFIG_VP9_HIGHBITDEPTH
     *out_sse = this_sse >> shift;
 
+    if (!x->block_tx_domain && p->eobs[block])
+      *out_dist += tx_domain_round_err[tx_size] << (3 + ss_txfrm_size);
+
     if (x->skip_encode && !is_inter_block(xd->mi[0])) {
       // TODO(jingning): tune the model to better capture the distortion.
       const int64_t p =
@@ -1823,7 +1861,7 @@ static void joint_motion_search(VP9_COMP *cpi, MACROBLOCK *x, BLOCK_SIZE bsize,
     if (bestsme < UINT_MAX) {
       uint32_t dis; /* TODO: use dis in distortion calculation later. */
       uint32_t sse;
-      bestsme = cpi->find_fractional_mv_step(
+      bestsme = get_fractional_mv_step(cpi, x)(
           x, &tmp_mv, &ref_mv[id].as_mv, cpi->common.allow_high_precision_mv,
           x->errorperbit, &cpi->fn_ptr[bsize], 0,
           cpi->sf.mv.subpel_iters_per_step, NULL, x->nmvjointcost, x->mvcost,
@@ -2009,7 +2047,7 @@ static int64_t rd_pick_best_sub8x8_mode(
 
           if (bestsme < UINT_MAX) {
             uint32_t distortion;
-            cpi->find_fractional_mv_step(
+            get_fractional_mv_step(cpi, x)(
                 x, new_mv, &bsi->ref_mv[0]->as_mv, cm->allow_high_precision_mv,
                 x->errorperbit, &cpi->fn_ptr[bsize], sf->mv.subpel_force_stop,
                 sf->mv.subpel_iters_per_step, cond_cost_list(cpi, cost_list),
@@ -2335,10 +2373,11 @@ static void single_motion_search(VP9_COMP *cpi, MACROBLOCK *x, BLOCK_SIZE bsize,
   const YV12_BUFFER_CONFIG *scaled_ref_frame =
       vp9_get_scaled_ref_frame(cpi, ref);
 
-  MV pred_mv[3];
+  MV pred_mv[4];
   pred_mv[0] = x->mbmi_ext->ref_mvs[ref][0].as_mv;
   pred_mv[1] = x->mbmi_ext->ref_mvs[ref][1].as_mv;
   pred_mv[2] = x->pred_mv[ref];
+  pred_mv[TEMPORAL_MV_REF_INDEX] = x->temporal_mv[ref];
 
   if (scaled_ref_frame) {
     int i;
@@ -2414,7 +2453,7 @@ static void single_motion_search(VP9_COMP *cpi, MACROBLOCK *x, BLOCK_SIZE bsize,
 
   if (bestsme < INT_MAX) {
     uint32_t dis; /* TODO: use dis in distortion calculation later. */
-    cpi->find_fractional_mv_step(
+    get_fractional_mv_step(cpi, x)(
         x, &tmp_mv->as_mv, &ref_mv, cm->allow_high_precision_mv, x->errorperbit,
         &cpi->fn_ptr[bsize], cpi->sf.mv.subpel_force_stop,
         cpi->sf.mv.subpel_iters_per_step, cond_cost_list(cpi, cost_list),
@@ -2460,6 +2499,57 @@ static int discount_newmv_test(const VP9_COMP *cpi, int this_mode,
            (mode_mv[NEARMV][ref_frame].as_int == INVALID_MV)));
 }
 
+static interp_pred_cache_entry *get_interp_pred_cache_entry(
+    interp_pred_cache *cache, const MODE_INFO *mi) {
+  const int is_comp_pred = has_second_ref(mi);
+  const int_mv mv1 = is_comp_pred ? mi->mv[1] : mi->mv[0];
+  interp_pred_cache_entry *entry;
+  int i;
+
+  for (i = 0; i < cache->num_entries; ++i) {
+    entry = &cache->entry[i];
+    if (entry->ref_frame[0] == mi->ref_frame[0] &&
+        entry->ref_frame[1] == mi->ref_frame[1] &&
+        entry->mv[0].as_int == mi->mv[0].as_int &&
+        entry->mv[1].as_int == mv1.as_int)
+      return entry;
+  }
+  if (cache->num_entries == INTERP_PRED_CACHE_SIZE) return NULL;
+
+  entry = &cache->entry[cache->num_entries++];
+  entry->ref_frame[0] = mi->ref_frame[0];
+  entry->ref_frame[1] = mi->ref_frame[1];
+  entry->mv[0] = mi->mv[0];
+  entry->mv[1] = mv1;
+  for (i = 0; i < SWITCHABLE_FILTERS; ++i) entry->filter[i].valid = 0;
+  return entry;
+}
+
+static void store_interp_model_rd(interp_model_rd *model, const MACROBLOCK *x,
+                                  int ref, int rate_sum, int64_t dist_sum,
+                                  int skip_sb, int64_t skip_sse) {
+  model->valid = 1;
+  model->rate_sum = rate_sum;
+  model->dist_sum = dist_sum;
+  model->skip_sb = skip_sb;
+  model->skip_sse = skip_sse;
+  model->pred_sse = x->pred_sse[ref];
+  memcpy(model->skip_txfm, x->skip_txfm, sizeof(model->skip_txfm));
+  memcpy(model->bsse, x->bsse, sizeof(model->bsse));
+}
+
+static void load_interp_model_rd(const interp_model_rd *model, MACROBLOCK *x,
+                                 int ref, int *rate_sum, int64_t *dist_sum,
+                                 int *skip_sb, int64_t *skip_sse) {
+  *rate_sum = model->rate_sum;
+  *dist_sum = model->dist_sum;
+  *skip_sb = model->skip_sb;
+  *skip_sse = model->skip_sse;
+  x->pred_sse[ref] = model->pred_sse;
+  memcpy(x->skip_txfm, model->skip_txfm, sizeof(model->skip_txfm));
+  memcpy(x->bsse, model->bsse, sizeof(model->bsse));
+}
+
 static int64_t handle_inter_mode(
     VP9_COMP *cpi, MACROBLOCK *x, BLOCK_SIZE bsize, int *rate2,
     int64_t *distortion, int *skippable, int *rate_y, int *rate_uv,
@@ -2467,7 +2557,8 @@ static int64_t handle_inter_mode(
     int mi_col, int_mv single_newmv[MAX_REF_FRAMES],
     INTERP_FILTER (*single_filter)[MAX_REF_FRAMES],
     int (*single_skippable)[MAX_REF_FRAMES], int64_t *psse,
-    const int64_t ref_best_rd, int64_t *mask_filter, int64_t filter_cache[]) {
+    const int64_t ref_best_rd, int64_t *mask_filter, int64_t filter_cache[],
+    interp_pred_cache *pred_cache) {
   VP9_COMMON *cm = &cpi->common;
   MACROBLOCKD *xd = &x->e_mbd;
   MODE_INFO *mi = xd->mi[0];
@@ -2486,6 +2577,8 @@ static int64_t handle_inter_mode(
   DECLARE_ALIGNED(16, uint8_t, tmp_buf[MAX_MB_PLANE * 64 * 64]);
 #endif  // CONFIG_VP9_HIGHBITDEPTH
   int pred_exists = 0;
+  int pred_from_cache = 0;
+  interp_pred_cache_entry *cache_entry;
   int intpel_mv;
   int64_t rd, tmp_rd, best_rd = INT64_MAX;
   int best_needs_copy = 0;
@@ -2617,6 +2710,7 @@ static int64_t handle_inter_mode(
     return INT64_MAX;
 
   pred_exists = 0;
+  cache_entry = get_interp_pred_cache_entry(pred_cache, mi);
   // Are all MVs integer pel for Y and UV
   intpel_mv = !mv_has_subpel(&mi->mv[0].as_mv);
   if (is_comp_pred) intpel_mv &= !mv_has_subpel(&mi->mv[1].as_mv);
@@ -2632,6 +2726,7 @@ static int64_t handle_inter_mode(
       int newbest;
       int tmp_rate_sum = 0;
       int64_t tmp_dist_sum = 0;
+      int model_from_cache = 0;
 
       for (i = 0; i < SWITCHABLE_FILTERS; ++i) {
         int j;
@@ -2660,20 +2755,32 @@ static int64_t handle_inter_mode(
             continue;
           }
 
-          if ((cm->interp_filter == SWITCHABLE && (!i || best_needs_copy)) ||
-              (cm->interp_filter != SWITCHABLE &&
-               (cm->interp_filter == mi->interp_filter ||
-                (i == 0 && intpel_mv)))) {
-            restore_dst_buf(xd, orig_dst, orig_dst_stride);
+          model_from_cache = cache_entry && cache_entry->filter[i].valid;
+          if (model_from_cache) {
+            // The prediction is only built again if this filter is chosen.
+            load_interp_model_rd(&cache_entry->filter[i], x, refs[0],
+                                 &rate_sum, &dist_sum, &tmp_skip_sb,
+                                 &tmp_skip_sse);
           } else {
-            for (j = 0; j < MAX_MB_PLANE; j++) {
-              xd->plane[j].dst.buf = tmp_buf + j * 64 * 64;
-              xd->plane[j].dst.stride = 64;
+            if ((cm->interp_filter == SWITCHABLE && (!i || best_needs_copy)) ||
+                (cm->interp_filter != SWITCHABLE &&
+                 (cm->interp_filter == mi->interp_filter ||
+                  (i == 0 && intpel_mv)))) {
+              restore_dst_buf(xd, orig_dst, orig_dst_stride);
+            } else {
+              for (j = 0; j < MAX_MB_PLANE; j++) {
+                xd->plane[j].dst.buf = tmp_buf + j * 64 * 64;
+                xd->plane[j].dst.stride = 64;
+              }
             }
+            vp9_build_inter_predictors_sb(xd, mi_row, mi_col, bsize);
+            model_rd_for_sb(cpi, bsize, x, xd, &rate_sum, &dist_sum,
+                            &tmp_skip_sb, &tmp_skip_sse);
+            if (cache_entry)
+              store_interp_model_rd(&cache_entry->filter[i], x, refs[0],
+                                    rate_sum, dist_sum, tmp_skip_sb,
+                                    tmp_skip_sse);
           }
-          vp9_build_inter_predictors_sb(xd, mi_row, mi_col, bsize);
-          model_rd_for_sb(cpi, bsize, x, xd, &rate_sum, &dist_sum, &tmp_skip_sb,
-                          &tmp_skip_sse);
 
           rd = RDCOST(x->rdmult, x->rddiv, rate_sum, dist_sum);
           filter_cache[i] = rd;
@@ -2699,7 +2806,8 @@ static int64_t handle_inter_mode(
         if (newbest) {
           best_rd = rd;
           best_filter = mi->interp_filter;
-          if (cm->interp_filter == SWITCHABLE && i && !intpel_mv)
+          if (cm->interp_filter == SWITCHABLE && i && !intpel_mv &&
+              !model_from_cache)
             best_needs_copy = !best_needs_copy;
         }
 
@@ -2707,6 +2815,7 @@ static int64_t handle_inter_mode(
             (cm->interp_filter != SWITCHABLE &&
              cm->interp_filter == mi->interp_filter)) {
           pred_exists = 1;
+          pred_from_cache = model_from_cache;
           tmp_rd = best_rd;
 
           skip_txfm_sb = tmp_skip_sb;
@@ -2724,7 +2833,10 @@ static int64_t handle_inter_mode(
   rs = cm->interp_filter == SWITCHABLE ? vp9_get_switchable_rate(cpi, xd) : 0;
 
   if (pred_exists) {
-    if (best_needs_copy) {
+    if (pred_from_cache) {
+      // No buffer holds the prediction of a filter whose model was reused.
+      vp9_build_inter_predictors_sb(xd, mi_row, mi_col, bsize);
+    } else if (best_needs_copy) {
       // again temporarily set the buffers to local memory to prevent a memcpy
       for (i = 0; i < MAX_MB_PLANE; i++) {
         xd->plane[i].dst.buf = tmp_buf + i * 64 * 64;
@@ -2739,8 +2851,18 @@ static int64_t handle_inter_mode(
     // switchable list (ex. bilinear) is indicated at the frame level, or
     // skip condition holds.
     vp9_build_inter_predictors_sb(xd, mi_row, mi_col, bsize);
-    model_rd_for_sb(cpi, bsize, x, xd, &tmp_rate, &tmp_dist, &skip_txfm_sb,
-                    &skip_sse_sb);
+    if (cache_entry && mi->interp_filter < SWITCHABLE_FILTERS &&
+        cache_entry->filter[mi->interp_filter].valid) {
+      load_interp_model_rd(&cache_entry->filter[mi->interp_filter], x, refs[0],
+                           &tmp_rate, &tmp_dist, &skip_txfm_sb, &skip_sse_sb);
+    } else {
+      model_rd_for_sb(cpi, bsize, x, xd, &tmp_rate, &tmp_dist, &skip_txfm_sb,
+                      &skip_sse_sb);
+      if (cache_entry && mi->interp_filter < SWITCHABLE_FILTERS)
+        store_interp_model_rd(&cache_entry->filter[mi->interp_filter], x,
+                              refs[0], tmp_rate, tmp_dist, skip_txfm_sb,
+                              skip_sse_sb);
+    }
     rd = RDCOST(x->rdmult, x->rddiv, rs + tmp_rate, tmp_dist);
     memcpy(skip_txfm, x->skip_txfm, sizeof(skip_txfm));
     memcpy(bsse, x->bsse, sizeof(bsse));
@@ -3051,8 +3173,10 @@ void vp9_rd_pick_inter_mode_sb(VP9_COMP *cpi, TileDataEnc *tile_data,
   const int mode_search_skip_flags = sf->mode_search_skip_flags;
   int64_t mask_filter = 0;
   int64_t filter_cache[SWITCHABLE_FILTER_CONTEXTS];
+  interp_pred_cache pred_cache;
 
   vp9_zero(best_mbmode);
+  pred_cache.num_entries = 0;
 
   x->skip_encode = sf->skip_encode_frame && x->q_index < QIDX_SKIP_THRESH;
 
@@ -3389,7 +3513,7 @@ void vp9_rd_pick_inter_mode_sb(VP9_COMP *cpi, TileDataEnc *tile_data,
           cpi, x, bsize, &rate2, &distortion2, &skippable, &rate_y, &rate_uv,
           &disable_skip, frame_mv, mi_row, mi_col, single_newmv,
           single_inter_filter, single_skippable, &total_sse, best_rd,
-          &mask_filter, filter_cache);
+          &mask_filter, filter_cache, &pred_cache);
       if (this_rd == INT64_MAX) continue;
 
       compmode_cost = vp9_cost_bit(comp_mode_p, comp_pred);
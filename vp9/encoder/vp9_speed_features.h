@@ -148,7 +148,11 @@ typedef enum {
   VAR_BASED_PARTITION,
 
   // Use non-fixed partitions based on source variance
-  SOURCE_VAR_BASED_PARTITION
+  SOURCE_VAR_BASED_PARTITION,
+
+  // Use the partitions of the mode hints set with VP9E_SET_MODE_INFO_HINTS.
+  // Only chosen per frame while there are hints, never as a speed feature.
+  MODE_HINT_PARTITION
 } PARTITION_SEARCH_TYPE;
 
 typedef enum {
@@ -191,6 +195,10 @@ typedef struct MV_SPEED_FEATURES {
 
   // This variable sets the step_param used in full pel motion search.
   int fullpel_search_step_param;
+
+  // Test the motion of the co-located block in earlier frames, scaled by
+  // temporal distance, as a starting point of the full pel motion search.
+  int use_temporal_mv;
 } MV_SPEED_FEATURES;
 
 typedef struct PARTITION_SEARCH_BREAKOUT_THR {
@@ -261,6 +269,11 @@ typedef struct SPEED_FEATURES {
   int allow_txfm_domain_distortion;
   double tx_domain_thresh;
 
+  // Estimate the pixel domain distortion of the blocks that do not use
+  // transform domain distortion from their transform domain error and the
+  // rounding error of the inverse transform, instead of reconstructing them.
+  int tx_domain_dist_model;
+
   // The threshold is to determine how slow the motino is, it is used when
   // use_lastframe_partitioning is set to LAST_FRAME_PARTITION_LOW_MOTION
   MOTION_THRESHOLD lf_motion_threshold;
@@ -455,6 +468,10 @@ typedef struct SPEED_FEATURES {
   // Machine-learning based partition search early termination
   int ml_partition_search_early_termination;
 
+  // Machine-learning based pruning of the split and rectangular partitions
+  // in rd_pick_partition().
+  int ml_prune_partition;
+
   // Allow skipping partition search for still image frame
   int allow_partition_search_skip;
 
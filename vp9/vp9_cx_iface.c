@@ -8,6 +8,7 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -53,6 +54,8 @@ struct vp9_extracfg {
   int render_height;
   unsigned int row_mt;
   unsigned int row_mt_bit_exact;
+  int twopass_chunk;
+  unsigned int early_packing;
 };
 
 static struct vp9_extracfg default_extra_cfg = {
@@ -86,6 +89,8 @@ static struct vp9_extracfg default_extra_cfg = {
   0,                     // render height
   0,                     // row_mt
   0,                     // row_mt_bit_exact
+  -1,                    // twopass_chunk
+  0,                     // early_packing
 };
 
 struct vpx_codec_alg_priv {
@@ -179,6 +184,18 @@ static vpx_codec_err_t validate_config(vpx_codec_alg_priv_t *ctx,
   RANGE_CHECK(cfg, g_pass, VPX_RC_ONE_PASS, VPX_RC_LAST_PASS);
   RANGE_CHECK(extra_cfg, min_gf_interval, 0, (MAX_LAG_BUFFERS - 1));
   RANGE_CHECK(extra_cfg, max_gf_interval, 0, (MAX_LAG_BUFFERS - 1));
+#if CONFIG_MULTI_RES_ENCODING
+  // Multi-resolution encoding reuses the motion of the lower resolution
+  // frame coded for the same input, which needs a one pass encode without
+  // lag or internal resizing.
+  if (ctx->base.enc.total_encoders > 1) {
+    RANGE_CHECK_HI(cfg, g_lag_in_frames, 0);
+    RANGE_CHECK_HI(cfg, rc_resize_allowed, 0);
+    RANGE_CHECK(cfg, g_pass, VPX_RC_ONE_PASS, VPX_RC_ONE_PASS);
+    RANGE_CHECK(cfg, ss_number_layers, 1, 1);
+    RANGE_CHECK(cfg, ts_number_layers, 1, 1);
+  }
+#endif
   if (extra_cfg->max_gf_interval > 0) {
     RANGE_CHECK(extra_cfg, max_gf_interval, 2, (MAX_LAG_BUFFERS - 1));
   }
@@ -251,6 +268,8 @@ static vpx_codec_err_t validate_config(vpx_codec_alg_priv_t *ctx,
 
   RANGE_CHECK(extra_cfg, row_mt, 0, 1);
   RANGE_CHECK(extra_cfg, row_mt_bit_exact, 0, 1);
+  RANGE_CHECK(extra_cfg, early_packing, 0, 1);
+  RANGE_CHECK_LO(extra_cfg, twopass_chunk, -1);
   RANGE_CHECK(extra_cfg, enable_auto_alt_ref, 0, 2);
   RANGE_CHECK(extra_cfg, cpu_used, -8, 8);
   RANGE_CHECK_HI(extra_cfg, noise_sensitivity, 6);
@@ -310,14 +329,17 @@ static vpx_codec_err_t validate_config(vpx_codec_alg_priv_t *ctx,
           ERROR("rc_twopass_stats_in missing EOS stats packet");
       }
     } else {
+      int n_chunks;
       if (cfg->rc_twopass_stats_in.sz < 2 * packet_sz)
         ERROR("rc_twopass_stats_in requires at least two packets.");
 
-      stats =
-          (const FIRSTPASS_STATS *)cfg->rc_twopass_stats_in.buf + n_packets - 1;
+      stats = cfg->rc_twopass_stats_in.buf;
+      n_chunks = vp9_count_stats_eos_packets(stats, n_packets);
+
+      if (n_chunks == 0) ERROR("rc_twopass_stats_in missing EOS stats packet");
 
-      if ((int)(stats->count + 0.5) != n_packets - 1)
-        ERROR("rc_twopass_stats_in missing EOS stats packet");
+      if (extra_cfg->twopass_chunk >= n_chunks)
+        ERROR("twopass_chunk out of range of rc_twopass_stats_in");
     }
   }
 
@@ -516,6 +538,7 @@ static vpx_codec_err_t set_encoder_config(
   oxcf->sharpness = extra_cfg->sharpness;
 
   oxcf->two_pass_stats_in = cfg->rc_twopass_stats_in;
+  oxcf->two_pass_chunk = extra_cfg->twopass_chunk;
 
 #if CONFIG_FP_MB_STATS
   oxcf->firstpass_mb_stats_in = cfg->rc_firstpass_mb_stats_in;
@@ -562,6 +585,7 @@ static vpx_codec_err_t set_encoder_config(
 
   oxcf->row_mt = extra_cfg->row_mt;
   oxcf->row_mt_bit_exact = extra_cfg->row_mt_bit_exact;
+  oxcf->early_packing = extra_cfg->early_packing;
 
   for (sl = 0; sl < oxcf->ss_number_layers; ++sl) {
 #if CONFIG_SPATIAL_SVC
@@ -865,6 +889,31 @@ static vpx_codec_err_t ctrl_enable_row_mt_bit_exact(vpx_codec_alg_priv_t *ctx,
   return update_extra_cfg(ctx, &extra_cfg);
 }
 
+static vpx_codec_err_t ctrl_set_twopass_chunk(vpx_codec_alg_priv_t *ctx,
+                                             va_list args) {
+  struct vp9_extracfg extra_cfg = ctx->extra_cfg;
+  VP9_COMP *const cpi = ctx->cpi;
+  vpx_codec_err_t res;
+  // The chunk selects the first pass stats the second pass is initialized
+  // from, so it can not change once frames have been passed to the encoder.
+  if (cpi->oxcf.pass == 2 &&
+      (cpi->common.current_video_frame > 0 ||
+       (cpi->lookahead != NULL && vp9_lookahead_depth(cpi->lookahead) > 0)))
+    return VPX_CODEC_INVALID_PARAM;
+  extra_cfg.twopass_chunk = CAST(VP9E_SET_TWOPASS_CHUNK, args);
+  res = update_extra_cfg(ctx, &extra_cfg);
+  if (res == VPX_CODEC_OK && cpi->oxcf.pass == 2 && !is_two_pass_svc(cpi))
+    vp9_init_second_pass(cpi);
+  return res;
+}
+
+static vpx_codec_err_t ctrl_set_early_packing(vpx_codec_alg_priv_t *ctx,
+                                              va_list args) {
+  struct vp9_extracfg extra_cfg = ctx->extra_cfg;
+  extra_cfg.early_packing = CAST(VP9E_SET_EARLY_PACKING, args);
+  return update_extra_cfg(ctx, &extra_cfg);
+}
+
 static vpx_codec_err_t ctrl_get_level(vpx_codec_alg_priv_t *ctx, va_list args) {
   int *const arg = va_arg(args, int *);
   if (arg == NULL) return VPX_CODEC_INVALID_PARAM;
@@ -872,10 +921,37 @@ static vpx_codec_err_t ctrl_get_level(vpx_codec_alg_priv_t *ctx, va_list args) {
   return VPX_CODEC_OK;
 }
 
+static vpx_codec_err_t encoder_mr_get_mem_loc(const vpx_codec_enc_cfg_t *cfg,
+                                              void **mem_loc) {
+#if CONFIG_MULTI_RES_ENCODING
+  // The highest resolution comes first; the shared motion field is sized for
+  // it and reused by every lower resolution.
+  const int mi_cols = (cfg->g_w + MI_SIZE - 1) >> MI_SIZE_LOG2;
+  const int mi_rows = (cfg->g_h + MI_SIZE - 1) >> MI_SIZE_LOG2;
+  LOWER_RES_FRAME_INFO *const info =
+      (LOWER_RES_FRAME_INFO *)calloc(1, sizeof(*info));
+  if (info == NULL) return VPX_CODEC_MEM_ERROR;
+  info->mvs = (int_mv *)calloc(mi_rows * mi_cols, sizeof(*info->mvs));
+  if (info->mvs == NULL) {
+    free(info);
+    return VPX_CODEC_MEM_ERROR;
+  }
+  info->is_frame_dropped = 1;
+  *mem_loc = info;
+  return VPX_CODEC_OK;
+#else
+  (void)cfg;
+  (void)mem_loc;
+  return VPX_CODEC_INCAPABLE;
+#endif
+}
+
 static vpx_codec_err_t encoder_init(vpx_codec_ctx_t *ctx,
                                     vpx_codec_priv_enc_mr_cfg_t *data) {
   vpx_codec_err_t res = VPX_CODEC_OK;
+#if !CONFIG_MULTI_RES_ENCODING
   (void)data;
+#endif
 
   if (ctx->priv == NULL) {
     vpx_codec_alg_priv_t *const priv = vpx_calloc(1, sizeof(*priv));
@@ -884,6 +960,9 @@ static vpx_codec_err_t encoder_init(vpx_codec_ctx_t *ctx,
     ctx->priv = (vpx_codec_priv_t *)priv;
     ctx->priv->init_flags = ctx->init_flags;
     ctx->priv->enc.total_encoders = 1;
+#if CONFIG_MULTI_RES_ENCODING
+    if (data != NULL) ctx->priv->enc.total_encoders = data->mr_total_resolutions;
+#endif
     priv->buffer_pool = (BufferPool *)vpx_calloc(1, sizeof(BufferPool));
     if (priv->buffer_pool == NULL) return VPX_CODEC_MEM_ERROR;
 
@@ -909,6 +988,15 @@ static vpx_codec_err_t encoder_init(vpx_codec_ctx_t *ctx,
 #if CONFIG_VP9_HIGHBITDEPTH
       priv->oxcf.use_highbitdepth =
           (ctx->init_flags & VPX_CODEC_USE_HIGHBITDEPTH) ? 1 : 0;
+#endif
+#if CONFIG_MULTI_RES_ENCODING
+      if (data != NULL) {
+        priv->oxcf.mr_total_resolutions = data->mr_total_resolutions;
+        priv->oxcf.mr_encoder_id = data->mr_encoder_id;
+        priv->oxcf.mr_down_sampling_factor = data->mr_down_sampling_factor;
+        priv->oxcf.mr_low_res_frame_info =
+            (LOWER_RES_FRAME_INFO *)data->mr_low_res_mode_info;
+      }
 #endif
       priv->cpi = vp9_create_compressor(&priv->oxcf, priv->buffer_pool);
       if (priv->cpi == NULL)
@@ -922,6 +1010,14 @@ static vpx_codec_err_t encoder_init(vpx_codec_ctx_t *ctx,
 }
 
 static vpx_codec_err_t encoder_destroy(vpx_codec_alg_priv_t *ctx) {
+#if CONFIG_MULTI_RES_ENCODING
+  // The highest resolution encoder owns the shared motion field.
+  if (ctx->oxcf.mr_total_resolutions > 0 &&
+      ctx->oxcf.mr_encoder_id == ctx->oxcf.mr_total_resolutions - 1) {
+    free(ctx->oxcf.mr_low_res_frame_info->mvs);
+    free(ctx->oxcf.mr_low_res_frame_info);
+  }
+#endif
   free(ctx->cx_data);
   vp9_remove_compressor(ctx->cpi);
 #if CONFIG_MULTITHREAD
@@ -1088,8 +1184,8 @@ static vpx_codec_err_t encoder_encode(vpx_codec_alg_priv_t *ctx,
                     svc->layer_context[svc->spatial_layer_id].target_bandwidth /
                     10000000.0);
     } else {
-      twopass->bits_left =
-          (int64_t)(stats->duration * oxcf->target_bandwidth / 10000000.0);
+      twopass->bits_left = (int64_t)(twopass->budget_duration *
+                                     oxcf->target_bandwidth / 10000000.0);
     }
     cpi->level_constraint.rc_config_updated = 1;
   }
@@ -1428,6 +1524,34 @@ static vpx_codec_err_t ctrl_get_active_map(vpx_codec_alg_priv_t *ctx,
   }
 }
 
+static vpx_codec_err_t ctrl_set_mode_info_hints(vpx_codec_alg_priv_t *ctx,
+                                                va_list args) {
+  const vpx_mode_info_t *const info = va_arg(args, vpx_mode_info_t *);
+
+  if (info) {
+    if (!vp9_set_mode_hints(ctx->cpi, info->blocks, info->mi_rows,
+                            info->mi_cols))
+      return VPX_CODEC_OK;
+    else
+      return VPX_CODEC_INVALID_PARAM;
+  } else {
+    vp9_set_mode_hints(ctx->cpi, NULL, 0, 0);
+    return VPX_CODEC_OK;
+  }
+}
+
+static vpx_codec_err_t ctrl_set_speed_target(vpx_codec_alg_priv_t *ctx,
+                                             va_list args) {
+  const vpx_speed_target_t *const target = va_arg(args, vpx_speed_target_t *);
+
+  if (target && target->frame_time <= INT_MAX && target->percentile <= 100 &&
+      !vp9_set_speed_target(ctx->cpi, (int)target->frame_time,
+                            (int)target->percentile))
+    return VPX_CODEC_OK;
+  else
+    return VPX_CODEC_INVALID_PARAM;
+}
+
 static vpx_codec_err_t ctrl_set_scale_mode(vpx_codec_alg_priv_t *ctx,
                                            va_list args) {
   vpx_scaling_mode_t *const mode = va_arg(args, vpx_scaling_mode_t *);
@@ -1622,6 +1746,10 @@ static vpx_codec_ctrl_fn_map_t encoder_ctrl_maps[] = {
   { VP9E_SET_TARGET_LEVEL, ctrl_set_target_level },
   { VP9E_SET_ROW_MT, ctrl_set_row_mt },
   { VP9E_ENABLE_ROW_MT_BIT_EXACT, ctrl_enable_row_mt_bit_exact },
+  { VP9E_SET_TWOPASS_CHUNK, ctrl_set_twopass_chunk },
+  { VP9E_SET_MODE_INFO_HINTS, ctrl_set_mode_info_hints },
+  { VP9E_SET_SPEED_TARGET, ctrl_set_speed_target },
+  { VP9E_SET_EARLY_PACKING, ctrl_set_early_packing },
 
   // Getters
   { VP8E_GET_LAST_QUANTIZER, ctrl_get_quantizer },
@@ -1727,6 +1855,6 @@ CODEC_INTERFACE(vpx_codec_vp9_cx) = {
       encoder_set_config,     // vpx_codec_enc_config_set_fn_t
       NULL,                   // vpx_codec_get_global_headers_fn_t
       encoder_get_preview,    // vpx_codec_get_preview_frame_fn_t
-      NULL                    // vpx_codec_enc_mr_get_mem_loc_fn_t
+      encoder_mr_get_mem_loc  // vpx_codec_enc_mr_get_mem_loc_fn_t
   }
 };
@@ -47,6 +47,8 @@ static vpx_codec_err_t decoder_init(vpx_codec_ctx_t *ctx,
     ctx->priv->init_flags = ctx->init_flags;
     priv->si.sz = sizeof(priv->si);
     priv->flushed = 0;
+    priv->tile_region.col_end = -1;
+    priv->tile_region.row_end = -1;
     // Only do frame parallel decode when threads > 1.
     priv->frame_parallel_decode =
         (ctx->config.dec && (ctx->config.dec->threads > 1) &&
@@ -97,6 +99,7 @@ static vpx_codec_err_t decoder_destroy(vpx_codec_alg_priv_t *ctx) {
     vp9_free_internal_frame_buffers(&ctx->buffer_pool->int_frame_buffers);
   }
 
+  vpx_free(ctx->mode_info);
   vpx_free(ctx->frame_workers);
   vpx_free(ctx->buffer_pool);
   vpx_free(ctx);
@@ -241,7 +244,7 @@ static void init_buffer_callbacks(vpx_codec_alg_priv_t *ctx) {
 
     cm->new_fb_idx = INVALID_IDX;
     cm->byte_alignment = ctx->byte_alignment;
-    cm->skip_loop_filter = ctx->skip_loop_filter;
+    cm->skip_loop_filter = ctx->skip_loop_filter || ctx->preview_level;
 
     if (ctx->get_ext_fb_cb != NULL && ctx->release_ext_fb_cb != NULL) {
       pool->get_fb_cb = ctx->get_ext_fb_cb;
@@ -260,6 +263,50 @@ static void init_buffer_callbacks(vpx_codec_alg_priv_t *ctx) {
   }
 }
 
+// Allocates the internal frame buffers requested with
+// VP9_SET_FRAME_BUFFER_PREALLOC through the same path as the frames use, so
+// that they get the exact size.
+static vpx_codec_err_t prealloc_frame_buffers(vpx_codec_alg_priv_t *ctx) {
+  const vpx_frame_buffer_prealloc_t *const prealloc = &ctx->prealloc;
+  BufferPool *const pool = ctx->buffer_pool;
+  InternalFrameBufferList *const list = &pool->int_frame_buffers;
+  vpx_codec_frame_buffer_t fb[VP9_MAXIMUM_REF_BUFFERS +
+                              VPX_MAXIMUM_WORK_BUFFERS];
+  const vpx_img_fmt_t fmt = prealloc->fmt ? prealloc->fmt : VPX_IMG_FMT_I420;
+  const vpx_img_fmt_t planes = fmt & ~VPX_IMG_FMT_HIGHBITDEPTH;
+  const int ss_x = planes == VPX_IMG_FMT_I420 || planes == VPX_IMG_FMT_I422;
+  const int ss_y = planes == VPX_IMG_FMT_I420 || planes == VPX_IMG_FMT_I440;
+  vpx_codec_err_t res = VPX_CODEC_OK;
+  int i, num_free = 0, num_allocated = 0;
+
+  lock_buffer_pool(pool);
+  for (i = 0; i < list->num_internal_frame_buffers; ++i)
+    num_free += !list->int_fb[i].in_use;
+
+  while (num_allocated < VPXMIN(prealloc->num_buffers, num_free)) {
+    YV12_BUFFER_CONFIG buf;
+    memset(&buf, 0, sizeof(buf));
+    if (vpx_realloc_frame_buffer(
+            &buf, prealloc->width, prealloc->height, ss_x, ss_y,
+#if CONFIG_VP9_HIGHBITDEPTH
+            (fmt & VPX_IMG_FMT_HIGHBITDEPTH) != 0,
+#endif
+            VP9_DEC_BORDER_IN_PIXELS, ctx->byte_alignment, &fb[num_allocated],
+            vp9_get_frame_buffer, list)) {
+      res = VPX_CODEC_MEM_ERROR;
+      break;
+    }
+    ++num_allocated;
+  }
+
+  for (i = 0; i < num_allocated; ++i) vp9_release_frame_buffer(list, &fb[i]);
+  unlock_buffer_pool(pool);
+
+  if (res != VPX_CODEC_OK)
+    set_error_detail(ctx, "Failed to preallocate frame buffers");
+  return res;
+}
+
 static void set_default_ppflags(vp8_postproc_cfg_t *cfg) {
   cfg->post_proc_flag = VP8_DEBLOCK | VP8_DEMACROBLOCK;
   cfg->deblocking_level = 4;
@@ -322,8 +369,8 @@ static vpx_codec_err_t init_decoder(vpx_codec_alg_priv_t *ctx) {
   ctx->need_resync = 1;
   ctx->num_frame_workers =
       (ctx->frame_parallel_decode == 1) ? ctx->cfg.threads : 1;
-  if (ctx->num_frame_workers > MAX_DECODE_THREADS)
-    ctx->num_frame_workers = MAX_DECODE_THREADS;
+  if (ctx->num_frame_workers > MAX_FRAME_WORKERS)
+    ctx->num_frame_workers = MAX_FRAME_WORKERS;
   ctx->available_threads = ctx->num_frame_workers;
   ctx->flushed = 0;
 
@@ -365,6 +412,7 @@ static vpx_codec_err_t init_decoder(vpx_codec_alg_priv_t *ctx) {
     frame_worker_data->scratch_buffer_size = 0;
     frame_worker_data->frame_context_ready = 0;
     frame_worker_data->received_frame = 0;
+    vpx_atomic_init(&frame_worker_data->num_row_waiters, 0);
 #if CONFIG_MULTITHREAD
     if (pthread_mutex_init(&frame_worker_data->stats_mutex, NULL)) {
       set_error_detail(ctx, "Failed to allocate frame_worker_data mutex");
@@ -377,11 +425,18 @@ static vpx_codec_err_t init_decoder(vpx_codec_alg_priv_t *ctx) {
     }
 #endif
     // If decoding in serial mode, FrameWorker thread could create tile worker
-    // thread or loopfilter thread.
+    // thread or loopfilter thread. In frame parallel mode the threads left
+    // over once every FrameWorker has one are shared out for tile decoding.
     frame_worker_data->pbi->max_threads =
-        (ctx->frame_parallel_decode == 0) ? ctx->cfg.threads : 0;
+        (ctx->frame_parallel_decode == 0)
+            ? ctx->cfg.threads
+            : ctx->cfg.threads / ctx->num_frame_workers;
 
     frame_worker_data->pbi->inv_tile_order = ctx->invert_tile_order;
+    frame_worker_data->pbi->tile_region = ctx->tile_region;
+    frame_worker_data->pbi->preview_level = ctx->preview_level;
+    frame_worker_data->pbi->drop_non_ref = ctx->drop_non_ref;
+    frame_worker_data->pbi->key_frames_only = ctx->key_frames_only;
     frame_worker_data->pbi->frame_parallel_decode = ctx->frame_parallel_decode;
     frame_worker_data->pbi->common.frame_parallel_decode =
         ctx->frame_parallel_decode;
@@ -399,6 +454,9 @@ static vpx_codec_err_t init_decoder(vpx_codec_alg_priv_t *ctx) {
 
   init_buffer_callbacks(ctx);
 
+  if (ctx->prealloc.num_buffers > 0 && ctx->get_ext_fb_cb == NULL)
+    return prealloc_frame_buffers(ctx);
+
   return VPX_CODEC_OK;
 }
 
@@ -410,12 +468,41 @@ static INLINE void check_resync(vpx_codec_alg_priv_t *const ctx,
     ctx->need_resync = 0;
 }
 
+// Passes rows of the frame being decoded to the put_slice callback.
+static void put_slice(void *priv, const YV12_BUFFER_CONFIG *buf, int y_start,
+                      int y_end) {
+  vpx_codec_alg_priv_t *const ctx = (vpx_codec_alg_priv_t *)priv;
+  const FrameWorkerData *const frame_worker_data =
+      (FrameWorkerData *)ctx->frame_workers[0].data1;
+  vpx_image_t img;
+  vpx_image_rect_t valid, update;
+
+  yuvconfig2image(&img, buf, frame_worker_data->user_priv);
+  valid.x = 0;
+  valid.y = 0;
+  valid.w = img.d_w;
+  valid.h = y_end;
+  update = valid;
+  update.y = y_start;
+  update.h = y_end - y_start;
+  ctx->base.dec.put_slice_cb.u.put_slice(ctx->base.dec.put_slice_cb.user_priv,
+                                         &img, &valid, &update);
+}
+
 static vpx_codec_err_t decode_one(vpx_codec_alg_priv_t *ctx,
                                   const uint8_t **data, unsigned int data_sz,
                                   void *user_priv, int64_t deadline) {
   const VPxWorkerInterface *const winterface = vpx_get_worker_interface();
+  const size_t header_size = VPXMIN(data_sz, MAX_VP9_HEADER_SIZE);
   (void)deadline;
 
+  // The headers are read before the decoder can wait for more data.
+  if (ctx->input_wait_cb != NULL &&
+      ctx->input_wait_cb(ctx->input_wait_state, header_size)) {
+    set_error_detail(ctx, "Failed to receive frame data");
+    return VPX_CODEC_CORRUPT_FRAME;
+  }
+
   // Determine the stream parameters. Note that we rely on peek_si to
   // validate that we have a buffer that does not wrap around the top
   // of the heap.
@@ -441,6 +528,13 @@ static vpx_codec_err_t decode_one(vpx_codec_alg_priv_t *ctx,
     // decrypt config between frames.
     frame_worker_data->pbi->decrypt_cb = ctx->decrypt_cb;
     frame_worker_data->pbi->decrypt_state = ctx->decrypt_state;
+    frame_worker_data->pbi->input_wait_cb = ctx->input_wait_cb;
+    frame_worker_data->pbi->input_wait_state = ctx->input_wait_state;
+    frame_worker_data->pbi->input_start = *data;
+    frame_worker_data->pbi->input_received = header_size;
+    frame_worker_data->pbi->rows_done_cb =
+        ctx->base.dec.put_slice_cb.u.put_slice ? put_slice : NULL;
+    frame_worker_data->pbi->rows_done_priv = ctx;
 
     worker->had_error = 0;
     winterface->execute(worker);
@@ -549,9 +643,14 @@ static vpx_codec_err_t decoder_decode(vpx_codec_alg_priv_t *ctx,
     if (res != VPX_CODEC_OK) return res;
   }
 
-  res = vp9_parse_superframe_index(data, data_sz, frame_sizes, &frame_count,
-                                   ctx->decrypt_cb, ctx->decrypt_state);
-  if (res != VPX_CODEC_OK) return res;
+  // Streaming input holds a single frame whose end may not have arrived.
+  if (ctx->input_wait_cb != NULL) {
+    frame_count = 0;
+  } else {
+    res = vp9_parse_superframe_index(data, data_sz, frame_sizes, &frame_count,
+                                     ctx->decrypt_cb, ctx->decrypt_state);
+    if (res != VPX_CODEC_OK) return res;
+  }
 
   if (ctx->svc_decoding && ctx->svc_spatial_layer < frame_count - 1)
     frame_count = ctx->svc_spatial_layer + 1;
@@ -633,6 +732,7 @@ static vpx_codec_err_t decoder_decode(vpx_codec_alg_priv_t *ctx,
         const vpx_codec_err_t res =
             decode_one(ctx, &data_start, frame_size, user_priv, deadline);
         if (res != VPX_CODEC_OK) return res;
+        if (ctx->input_wait_cb != NULL) break;
 
         // Account for suboptimal termination by the encoder.
         while (data_start < data_end) {
@@ -890,6 +990,36 @@ static vpx_codec_err_t ctrl_get_frame_corrupted(vpx_codec_alg_priv_t *ctx,
   return VPX_CODEC_INVALID_PARAM;
 }
 
+static vpx_codec_err_t ctrl_get_valid_region(vpx_codec_alg_priv_t *ctx,
+                                             va_list args) {
+  vpx_image_rect_t *const rect = va_arg(args, vpx_image_rect_t *);
+
+  if (rect) {
+    if (ctx->frame_workers) {
+      VPxWorker *const worker = ctx->frame_workers;
+      FrameWorkerData *const frame_worker_data =
+          (FrameWorkerData *)worker->data1;
+      RefCntBuffer *const frame_bufs =
+          frame_worker_data->pbi->common.buffer_pool->frame_bufs;
+      if (frame_worker_data->pbi->common.frame_to_show == NULL)
+        return VPX_CODEC_ERROR;
+      if (ctx->last_show_frame >= 0) {
+        const RefCntBuffer *const buf = &frame_bufs[ctx->last_show_frame];
+        const int w = buf->valid_x_end - buf->valid_x_start;
+        rect->x = buf->valid_x_start;
+        rect->y = 0;
+        rect->w = w > 0 ? w : 0;
+        rect->h = w > 0 && buf->valid_y_end > 0 ? buf->valid_y_end : 0;
+      }
+      return VPX_CODEC_OK;
+    } else {
+      return VPX_CODEC_ERROR;
+    }
+  }
+
+  return VPX_CODEC_INVALID_PARAM;
+}
+
 static vpx_codec_err_t ctrl_get_frame_size(vpx_codec_alg_priv_t *ctx,
                                            va_list args) {
   int *const frame_size = va_arg(args, int *);
@@ -1007,12 +1137,205 @@ static vpx_codec_err_t ctrl_set_skip_loop_filter(vpx_codec_alg_priv_t *ctx,
   if (ctx->frame_workers) {
     VPxWorker *const worker = ctx->frame_workers;
     FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
-    frame_worker_data->pbi->common.skip_loop_filter = ctx->skip_loop_filter;
+    frame_worker_data->pbi->common.skip_loop_filter =
+        ctx->skip_loop_filter || ctx->preview_level;
+  }
+
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_set_fast_preview(vpx_codec_alg_priv_t *ctx,
+                                             va_list args) {
+  const int level = va_arg(args, int);
+  int i;
+
+  if (level < 0 || level > 2) return VPX_CODEC_INVALID_PARAM;
+  ctx->preview_level = level;
+
+  for (i = 0; i < ctx->num_frame_workers; ++i) {
+    VPxWorker *const worker = &ctx->frame_workers[i];
+    FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
+    frame_worker_data->pbi->preview_level = ctx->preview_level;
+    frame_worker_data->pbi->common.skip_loop_filter =
+        ctx->skip_loop_filter || ctx->preview_level;
+  }
+
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_set_drop_non_reference(vpx_codec_alg_priv_t *ctx,
+                                                   va_list args) {
+  int i;
+
+  // Only support this function in serial decode.
+  if (ctx->frame_parallel_decode) {
+    set_error_detail(ctx, "Not supported in frame parallel decode");
+    return VPX_CODEC_INCAPABLE;
+  }
+
+  ctx->drop_non_ref = va_arg(args, int) != 0;
+  for (i = 0; i < ctx->num_frame_workers; ++i) {
+    VPxWorker *const worker = &ctx->frame_workers[i];
+    FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
+    frame_worker_data->pbi->drop_non_ref = ctx->drop_non_ref;
+  }
+
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_set_key_frames_only(vpx_codec_alg_priv_t *ctx,
+                                                va_list args) {
+  int i;
+
+  // Only support this function in serial decode.
+  if (ctx->frame_parallel_decode) {
+    set_error_detail(ctx, "Not supported in frame parallel decode");
+    return VPX_CODEC_INCAPABLE;
+  }
+
+  ctx->key_frames_only = va_arg(args, int) != 0;
+  for (i = 0; i < ctx->num_frame_workers; ++i) {
+    VPxWorker *const worker = &ctx->frame_workers[i];
+    FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
+    frame_worker_data->pbi->key_frames_only = ctx->key_frames_only;
+  }
+
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_set_input_wait(vpx_codec_alg_priv_t *ctx,
+                                           va_list args) {
+  vpx_input_wait_init *init = va_arg(args, vpx_input_wait_init *);
+
+  // Only support this function in serial decode.
+  if (ctx->frame_parallel_decode) {
+    set_error_detail(ctx, "Not supported in frame parallel decode");
+    return VPX_CODEC_INCAPABLE;
+  }
+
+  ctx->input_wait_cb = init ? init->wait_cb : NULL;
+  ctx->input_wait_state = init ? init->wait_state : NULL;
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_set_frame_buffer_prealloc(
+    vpx_codec_alg_priv_t *ctx, va_list args) {
+  const vpx_frame_buffer_prealloc_t *const prealloc =
+      va_arg(args, vpx_frame_buffer_prealloc_t *);
+  const vpx_img_fmt_t planes =
+      prealloc ? prealloc->fmt & ~VPX_IMG_FMT_HIGHBITDEPTH : VPX_IMG_FMT_NONE;
+
+  if (ctx->get_ext_fb_cb != NULL) {
+    set_error_detail(ctx, "Not supported with external frame buffers");
+    return VPX_CODEC_INCAPABLE;
+  }
+
+  if (prealloc == NULL || prealloc->width == 0 || prealloc->height == 0 ||
+      prealloc->width > 65536 || prealloc->height > 65536 ||
+      prealloc->num_buffers < 0 ||
+      prealloc->num_buffers >
+          VP9_MAXIMUM_REF_BUFFERS + VPX_MAXIMUM_WORK_BUFFERS)
+    return VPX_CODEC_INVALID_PARAM;
+  if (planes != VPX_IMG_FMT_NONE && planes != VPX_IMG_FMT_I420 &&
+      planes != VPX_IMG_FMT_I422 && planes != VPX_IMG_FMT_I440 &&
+      planes != VPX_IMG_FMT_I444)
+    return VPX_CODEC_INVALID_PARAM;
+#if !CONFIG_VP9_HIGHBITDEPTH
+  if (prealloc->fmt & VPX_IMG_FMT_HIGHBITDEPTH) return VPX_CODEC_INVALID_PARAM;
+#endif
+
+  ctx->prealloc = *prealloc;
+  if (ctx->frame_workers == NULL) return VPX_CODEC_OK;
+  return prealloc_frame_buffers(ctx);
+}
+
+static vpx_codec_err_t ctrl_get_frame_buffer_stats(vpx_codec_alg_priv_t *ctx,
+                                                   va_list args) {
+  vpx_frame_buffer_stats_t *const stats =
+      va_arg(args, vpx_frame_buffer_stats_t *);
+  int i;
+
+  if (stats == NULL) return VPX_CODEC_INVALID_PARAM;
+  if (ctx->get_ext_fb_cb != NULL) {
+    set_error_detail(ctx, "Not supported with external frame buffers");
+    return VPX_CODEC_INCAPABLE;
+  }
+
+  memset(stats, 0, sizeof(*stats));
+  if (ctx->buffer_pool != NULL) {
+    BufferPool *const pool = ctx->buffer_pool;
+    const InternalFrameBufferList *const list = &pool->int_frame_buffers;
+    lock_buffer_pool(pool);
+    stats->current_bytes = list->total_size;
+    stats->peak_bytes = list->peak_size;
+    for (i = 0; i < list->num_internal_frame_buffers; ++i) {
+      stats->num_allocated += list->int_fb[i].size > 0;
+      stats->num_in_use += list->int_fb[i].in_use;
+    }
+    unlock_buffer_pool(pool);
   }
 
   return VPX_CODEC_OK;
 }
 
+static vpx_codec_err_t ctrl_get_mode_info(vpx_codec_alg_priv_t *ctx,
+                                          va_list args) {
+  vpx_mode_info_t *const info = va_arg(args, vpx_mode_info_t *);
+  const VP9Decoder *pbi;
+  const VP9_COMMON *cm;
+  int mi_row, mi_col, ref;
+
+  // Only support this function in serial decode.
+  if (ctx->frame_parallel_decode) {
+    set_error_detail(ctx, "Not supported in frame parallel decode");
+    return VPX_CODEC_INCAPABLE;
+  }
+
+  if (info == NULL) return VPX_CODEC_INVALID_PARAM;
+  if (ctx->frame_workers == NULL) return VPX_CODEC_ERROR;
+
+  pbi = ((FrameWorkerData *)ctx->frame_workers[0].data1)->pbi;
+  cm = &pbi->common;
+  // The mode info of frames and tile rows left out by the decoder is not read.
+  if (cm->frame_to_show == NULL || cm->show_existing_frame || pbi->dropped ||
+      pbi->region_row_end < (1 << cm->log2_tile_rows) - 1) {
+    set_error_detail(ctx, "No mode info for the last frame");
+    return VPX_CODEC_ERROR;
+  }
+
+  if (ctx->mode_info_size < cm->mi_rows * cm->mi_cols) {
+    vpx_free(ctx->mode_info);
+    ctx->mode_info_size = 0;
+    ctx->mode_info = (vpx_block_mode_info_t *)vpx_malloc(
+        cm->mi_rows * cm->mi_cols * sizeof(*ctx->mode_info));
+    if (ctx->mode_info == NULL) return VPX_CODEC_MEM_ERROR;
+    ctx->mode_info_size = cm->mi_rows * cm->mi_cols;
+  }
+
+  for (mi_row = 0; mi_row < cm->mi_rows; ++mi_row) {
+    for (mi_col = 0; mi_col < cm->mi_cols; ++mi_col) {
+      const MODE_INFO *const mi =
+          cm->mi_grid_visible[mi_row * cm->mi_stride + mi_col];
+      vpx_block_mode_info_t *const block =
+          &ctx->mode_info[mi_row * cm->mi_cols + mi_col];
+      block->width = 4 << b_width_log2_lookup[mi->sb_type];
+      block->height = 4 << b_height_log2_lookup[mi->sb_type];
+      block->skip = mi->skip;
+      for (ref = 0; ref < 2; ++ref) {
+        const int inter = mi->ref_frame[ref] > INTRA_FRAME;
+        block->ref_frame[ref] = mi->ref_frame[ref];
+        block->mv_row[ref] = inter ? mi->mv[ref].as_mv.row : 0;
+        block->mv_col[ref] = inter ? mi->mv[ref].as_mv.col : 0;
+      }
+    }
+  }
+
+  info->mi_rows = cm->mi_rows;
+  info->mi_cols = cm->mi_cols;
+  info->blocks = ctx->mode_info;
+  return VPX_CODEC_OK;
+}
+
 static vpx_codec_err_t ctrl_set_spatial_layer_svc(vpx_codec_alg_priv_t *ctx,
                                                   va_list args) {
   ctx->svc_decoding = 1;
@@ -1023,6 +1346,29 @@ static vpx_codec_err_t ctrl_set_spatial_layer_svc(vpx_codec_alg_priv_t *ctx,
     return VPX_CODEC_OK;
 }
 
+static vpx_codec_err_t ctrl_set_decode_tile_region(vpx_codec_alg_priv_t *ctx,
+                                                   va_list args) {
+  const vpx_tile_region_t *const region = va_arg(args, vpx_tile_region_t *);
+  int i;
+
+  if (region) {
+    if (region->col_start < 0) return VPX_CODEC_INVALID_PARAM;
+    ctx->tile_region = *region;
+  } else {
+    ctx->tile_region.col_start = 0;
+    ctx->tile_region.col_end = -1;
+    ctx->tile_region.row_end = -1;
+  }
+
+  for (i = 0; i < ctx->num_frame_workers; ++i) {
+    VPxWorker *const worker = &ctx->frame_workers[i];
+    FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
+    frame_worker_data->pbi->tile_region = ctx->tile_region;
+  }
+
+  return VPX_CODEC_OK;
+}
+
 static vpx_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { VP8_COPY_REFERENCE, ctrl_copy_reference },
 
@@ -1034,15 +1380,24 @@ static vpx_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { VP9_SET_BYTE_ALIGNMENT, ctrl_set_byte_alignment },
   { VP9_SET_SKIP_LOOP_FILTER, ctrl_set_skip_loop_filter },
   { VP9_DECODE_SVC_SPATIAL_LAYER, ctrl_set_spatial_layer_svc },
+  { VP9_SET_DECODE_TILE_REGION, ctrl_set_decode_tile_region },
+  { VP9_SET_FAST_PREVIEW, ctrl_set_fast_preview },
+  { VP9_SET_DROP_NON_REFERENCE, ctrl_set_drop_non_reference },
+  { VP9_SET_KEY_FRAMES_ONLY, ctrl_set_key_frames_only },
+  { VP9_SET_FRAME_BUFFER_PREALLOC, ctrl_set_frame_buffer_prealloc },
+  { VP9D_SET_INPUT_WAIT, ctrl_set_input_wait },
 
   // Getters
   { VPXD_GET_LAST_QUANTIZER, ctrl_get_quantizer },
   { VP8D_GET_LAST_REF_UPDATES, ctrl_get_last_ref_updates },
   { VP8D_GET_FRAME_CORRUPTED, ctrl_get_frame_corrupted },
+  { VP9D_GET_VALID_REGION, ctrl_get_valid_region },
   { VP9_GET_REFERENCE, ctrl_get_reference },
   { VP9D_GET_DISPLAY_SIZE, ctrl_get_render_size },
   { VP9D_GET_BIT_DEPTH, ctrl_get_bit_depth },
   { VP9D_GET_FRAME_SIZE, ctrl_get_frame_size },
+  { VP9D_GET_FRAME_BUFFER_STATS, ctrl_get_frame_buffer_stats },
+  { VP9D_GET_MODE_INFO, ctrl_get_mode_info },
 
   { -1, NULL },
 };
@@ -1056,7 +1411,7 @@ CODEC_INTERFACE(vpx_codec_vp9_dx) = {
 #if CONFIG_VP9_HIGHBITDEPTH
   VPX_CODEC_CAP_HIGHBITDEPTH |
 #endif
-      VPX_CODEC_CAP_DECODER | VP9_CAP_POSTPROC |
+      VPX_CODEC_CAP_DECODER | VP9_CAP_POSTPROC | VPX_CODEC_CAP_PUT_SLICE |
       VPX_CODEC_CAP_EXTERNAL_FRAME_BUFFER,  // vpx_codec_caps_t
   decoder_init,                             // vpx_codec_init_fn_t
   decoder_destroy,                          // vpx_codec_destroy_fn_t
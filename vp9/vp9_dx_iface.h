@@ -19,6 +19,11 @@ typedef vpx_codec_stream_info_t vp9_stream_info_t;
 // TODO(hkuang): Remove this limit after implementing ondemand framebuffers.
 #define FRAME_CACHE_SIZE 6  // Cache maximum 6 decoded frames.
 
+// Each frame worker holds one frame buffer while it decodes, so the number of
+// frames in flight is bounded by the buffer pool. Threads beyond this are
+// given to the frame workers for tile and loop filter decoding.
+#define MAX_FRAME_WORKERS 8
+
 typedef struct cache_frame {
   int fb_idx;
   vpx_image_t img;
@@ -32,6 +37,8 @@ struct vpx_codec_alg_priv {
   vp8_postproc_cfg_t postproc_cfg;
   vpx_decrypt_cb decrypt_cb;
   void *decrypt_state;
+  vpx_input_wait_cb input_wait_cb;
+  void *input_wait_state;
   vpx_image_t img;
   int img_avail;
   int flushed;
@@ -39,6 +46,13 @@ struct vpx_codec_alg_priv {
   int last_show_frame;  // Index of last output frame.
   int byte_alignment;
   int skip_loop_filter;
+  vpx_tile_region_t tile_region;
+  int preview_level;
+  int drop_non_ref;
+  int key_frames_only;
+  vpx_frame_buffer_prealloc_t prealloc;
+  vpx_block_mode_info_t *mode_info;  // Returned by VP9D_GET_MODE_INFO.
+  int mode_info_size;
 
   // Frame parallel related.
   int frame_parallel_decode;  // frame-based threading.
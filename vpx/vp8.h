@@ -121,6 +121,33 @@ typedef struct vp9_ref_frame {
   vpx_image_t img; /**< img structure to populate (output) */
 } vp9_ref_frame_t;
 
+/*!\brief Mode info of an 8x8 block of a VP9 frame
+ *
+ * Describes the prediction block that covers the 8x8 block. Blocks smaller
+ * than 8x8 carry the motion vectors of their bottom right 4x4 block.
+ */
+typedef struct vpx_block_mode_info {
+  unsigned char width;  /**< width of the prediction block in pixels */
+  unsigned char height; /**< height of the prediction block in pixels */
+  /*!\brief reference frames: 0 for intra, 1 for last, 2 for golden and 3 for
+   * altref. The second is -1 when the block has a single reference. */
+  signed char ref_frame[2];
+  unsigned char skip; /**< the block has no residual */
+  short mv_row[2];    /**< motion vector rows per reference, in 1/8 pixels */
+  short mv_col[2];    /**< motion vector columns per reference */
+} vpx_block_mode_info_t;
+
+/*!\brief Mode info of a VP9 frame
+ *
+ * Used by VP9D_GET_MODE_INFO and VP9E_SET_MODE_INFO_HINTS.
+ */
+typedef struct vpx_mode_info {
+  int mi_rows; /**< number of 8x8 block rows of the frame */
+  int mi_cols; /**< number of 8x8 block columns of the frame */
+  /*!\brief mi_rows * mi_cols blocks in raster order */
+  vpx_block_mode_info_t *blocks;
+} vpx_mode_info_t;
+
 /*!\cond */
 /*!\brief vp8 decoder control function parameter type
  *
@@ -594,6 +594,81 @@ enum vp8e_enc_control_id {
     * Supported in codecs: VP8
     */
   VP8E_SET_GF_CBR_BOOST_PCT,
+
+  /*!\brief Codec control function to encode one chunk of a stitched first
+   * pass stats buffer in the second pass.
+   *
+   * Long clips can be split at key frames into chunks that are encoded in
+   * parallel, in separate encoder instances or processes. Each chunk is run
+   * through the first pass on its own; the stats are then stitched into one
+   * rc_twopass_stats_in buffer by concatenating the per-frame stats packets
+   * of all chunks in order, followed by the end of stream packet (the last
+   * stats packet output by each first pass) of every chunk in the same order.
+   *
+   * The second pass for chunk n is given the whole stitched buffer, this
+   * control set to n, and only the frames of chunk n. The chunk gets its
+   * share of the bit budget of the whole stream in proportion to its
+   * complexity, so the chunks together still respect the rate target.
+   * Must be set before the first frame is passed to the encoder.
+   *
+   * -1 : encode the whole stream (default), n >= 0 : encode chunk n
+   *
+   * Supported in codecs: VP9
+   */
+  VP9E_SET_TWOPASS_CHUNK,
+
+  /*!\brief Codec control function to give the encoder the mode info of the
+   * next frame it codes, vpx_mode_info_t* parameter.
+   *
+   * Meant for transcoding at the same resolution: the mode info of a decoded
+   * frame (see VP9D_GET_MODE_INFO) is passed with the frame. In real-time
+   * mode the blocks are coded with the block sizes of the hints, and their
+   * last frame motion vectors are refined by a local search instead of a
+   * full motion search. Otherwise the partition search is limited to block
+   * sizes close to those of the hints. The hints are copied, and are ignored
+   * if the frame is coded as an intra frame, is not shown, or does not
+   * have the size of the hints. Since they apply to the next frame coded,
+   * g_lag_in_frames should be 0. NULL drops hints not used yet.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9E_SET_MODE_INFO_HINTS,
+
+  /*!\brief Codec control function to adapt the speed of real-time encoding
+   * to a frame encode time target, vpx_speed_target_t* parameter.
+   *
+   * The encoder measures the time it takes to encode each frame, and raises
+   * the speed (see VP8E_SET_CPUUSED) for the next frame when too many of the
+   * last frames went over the target for the percentile to be met. Once a
+   * window of frames has met the target with a margin, the speed is lowered
+   * again, down to the speed set with VP8E_SET_CPUUSED. The speed stays on
+   * the search path of that speed: below 5 or from 5 to 8. Within a frame,
+   * superblocks coded after their share of the target has run out use a
+   * fixed partitioning and skip the sub-pixel motion search. Each frame is
+   * followed by a VPX_CODEC_SPEED_PKT with its encode time, the number of
+   * such superblocks and the speed picked for the next frame. Only applies
+   * to one pass real-time encoding without spatial layers. A target of 0
+   * turns the control off (default).
+   *
+   * Supported in codecs: VP9
+   */
+  VP9E_SET_SPEED_TARGET,
+
+  /*!\brief Codec control function to pack the bitstream of inter frames as
+   * they are encoded, unsigned int parameter.
+   *
+   * Each superblock row is packed right after it is encoded instead of after
+   * the whole frame, which lowers the latency of the frame. The probability
+   * updates of the frame are then chosen from the statistics of the previous
+   * frame, which costs some compression. Key frames, intra-only frames,
+   * frames that update the segmentation map and frames coded with a recode
+   * loop or row based multi-threading are packed after encoding as before.
+   *
+   * 0 : off (default), 1 : on
+   *
+   * Supported in codecs: VP9
+   */
+  VP9E_SET_EARLY_PACKING,
 };
 
 /*!\brief vpx 1-D scaling mode
@@ -732,6 +807,15 @@ typedef struct vpx_svc_ref_frame_config {
   int alt_fb_idx[VPX_TS_MAX_LAYERS];  /**< Altref buffer index. */
 } vpx_svc_ref_frame_config_t;
 
+/*!\brief vp9 encode time target
+ *
+ * Used with the #VP9E_SET_SPEED_TARGET control.
+ */
+typedef struct vpx_speed_target {
+  unsigned int frame_time; /**< Encode time target in microseconds, 0: off */
+  unsigned int percentile; /**< Percentage of frames within target, 1-100 */
+} vpx_speed_target_t;
+
 /*!\cond */
 /*!\brief VP8 encoder control function parameter type
  *
@@ -864,6 +948,18 @@ VPX_CTRL_USE_TYPE(VP9E_ENABLE_ROW_MT_BIT_EXACT, unsigned int)
 VPX_CTRL_USE_TYPE(VP9E_GET_LEVEL, int *)
 #define VPX_CTRL_VP9E_GET_LEVEL
 
+VPX_CTRL_USE_TYPE(VP9E_SET_TWOPASS_CHUNK, int)
+#define VPX_CTRL_VP9E_SET_TWOPASS_CHUNK
+
+VPX_CTRL_USE_TYPE(VP9E_SET_MODE_INFO_HINTS, vpx_mode_info_t *)
+#define VPX_CTRL_VP9E_SET_MODE_INFO_HINTS
+
+VPX_CTRL_USE_TYPE(VP9E_SET_SPEED_TARGET, vpx_speed_target_t *)
+#define VPX_CTRL_VP9E_SET_SPEED_TARGET
+
+VPX_CTRL_USE_TYPE(VP9E_SET_EARLY_PACKING, unsigned int)
+#define VPX_CTRL_VP9E_SET_EARLY_PACKING
+
 /*!\endcond */
 /*! @} - end defgroup vp8_encoder */
 #ifdef __cplusplus
@@ -124,6 +124,144 @@ enum vp8_dec_control_id {
    */
   VPXD_GET_LAST_QUANTIZER,
 
+  /*!\brief Codec control function to reconstruct only a region of tiles,
+   * vpx_tile_region_t* parameter.
+   *
+   * Tiles outside the region are still entropy decoded, since VP9 probability
+   * adaptation and motion vector prediction depend on every tile, but they
+   * are neither predicted, reconstructed nor loop filtered. Their pixels are
+   * left undefined. Tile rows above the region are always reconstructed as
+   * intra prediction reads across tile rows. Passing NULL restores full frame
+   * decoding.
+   *
+   * Pixels near the region boundary or predicted from outside the region of a
+   * reference may not match a full decode. The decoder tracks these
+   * dependencies, see VP9D_GET_VALID_REGION.
+   *
+   * Ignored in frame parallel mode.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9_SET_DECODE_TILE_REGION,
+
+  /*!\brief Codec control function to get the area of the last output frame
+   * that matches a full decode, vpx_image_rect_t* parameter.
+   *
+   * The rectangle is in luma pixels and covers the whole frame unless
+   * VP9_SET_DECODE_TILE_REGION was used. It may shrink from frame to frame as
+   * blocks inside the region predict from pixels a reference did not
+   * reconstruct, and grows back on the next key or intra-only frame.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9D_GET_VALID_REGION,
+
+  /*!\brief Codec control function to trade quality for decode speed when the
+   * output is only used at a reduced resolution, int parameter.
+   *
+   * 0 decodes normally (default). 1 and 2 target 1/2 and 1/4 resolution
+   * output: high frequency coefficients of inter blocks that would not survive
+   * the downscale are dropped so cheaper inverse transforms can be used, the
+   * loop filter is skipped, and frames that no other frame predicts from are
+   * parsed but neither reconstructed nor output. Errors accumulate until the
+   * next key frame.
+   *
+   * Frames are still output at full size. Frame skipping is not done in
+   * frame parallel mode.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9_SET_FAST_PREVIEW,
+
+  /*!\brief Codec control function to drop the following frames if no other
+   * frame references them, int parameter.
+   *
+   * While set to 1, frames that refresh no reference buffer are only read up
+   * to their headers and are not output, as with the upper temporal layers
+   * of an error resilient stream. Shown frames are only dropped in error
+   * resilient mode, since the next frame may otherwise predict from their
+   * motion vectors, and only when their entropy contexts and segmentation
+   * map are not carried over to later frames. A later frame that predicts
+   * from the motion vectors of a dropped frame fails to decode.
+   *
+   * Not supported in frame parallel mode.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9_SET_DROP_NON_REFERENCE,
+
+  /*!\brief Codec control function to decode only the frames that can be
+   * decoded on their own, int parameter.
+   *
+   * While set to 1, only key frames and intra-only frames that reset the
+   * entropy contexts they use are decoded. Other frames are skipped after
+   * reading their first header bytes and are not output. This makes seeking
+   * and trick play cheap. Since the skipped frames leave the references stale,
+   * the decoder needs a key or intra-only frame before decoding inter frames
+   * again.
+   *
+   * Not supported in frame parallel mode.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9_SET_KEY_FRAMES_ONLY,
+
+  /*!\brief Codec control function to allocate the internal frame buffers
+   * ahead of decoding, vpx_frame_buffer_prealloc_t* parameter.
+   *
+   * Allocating the buffers for the largest frame size of a stream up front
+   * avoids reallocating them when the frame size changes mid-stream. The
+   * buffers are allocated on the first decode if this is called before it,
+   * and that decode fails if they can't be. Buffers in use at the time of
+   * the call are left alone.
+   *
+   * Not supported with external frame buffers.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9_SET_FRAME_BUFFER_PREALLOC,
+
+  /*!\brief Codec control function to get the memory used by the internal
+   * frame buffers, vpx_frame_buffer_stats_t* parameter.
+   *
+   * Not supported with external frame buffers.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9D_GET_FRAME_BUFFER_STATS,
+
+  /*!\brief Codec control function to decode frames while their data is
+   * still arriving, vpx_input_wait_init* parameter.
+   *
+   * vpx_codec_decode() is then called with the whole size of a single frame
+   * as soon as its first bytes are in the buffer, and the decoder calls the
+   * wait callback before reading further than the data seen so far. Tiles
+   * are decoded as they arrive: a tile row at a time when decoding on one
+   * thread, and a tile at a time when tile columns are decoded on several.
+   * vpx_codec_decode() may return before the data after the last tile it
+   * uses has arrived. The buffer must not hold a superframe.
+   *
+   * Not supported in frame parallel mode.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9D_SET_INPUT_WAIT,
+
+  /*!\brief Codec control function to get the mode info of the last decoded
+   * frame, vpx_mode_info_t* parameter.
+   *
+   * Gives the block sizes, reference frames, motion vectors and skip flags
+   * the frame was coded with, e.g. to pass to VP9E_SET_MODE_INFO_HINTS when
+   * transcoding. The blocks are owned by the decoder and stay valid until
+   * the next call to vpx_codec_decode(). Fails if the last frame was dropped,
+   * was a repeat of an earlier frame, or was only partly decoded.
+   *
+   * Not supported in frame parallel mode.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9D_GET_MODE_INFO,
+
   VP8_DECODER_CTRL_ID_MAX
 };
 
@@ -149,6 +287,56 @@ typedef struct vpx_decrypt_init {
  */
 typedef vpx_decrypt_init vp8_decrypt_init;
 
+/** Block until the first size bytes of the buffer passed to
+ *  vpx_codec_decode() have arrived, using the wait_state passed in
+ *  VP9D_SET_INPUT_WAIT. Returns 0 on success, or nonzero if the data will
+ *  not arrive, which fails the decode.
+ */
+typedef int (*vpx_input_wait_cb)(void *wait_state, size_t size);
+
+/*!\brief Structure to hold the input wait state
+ *
+ * Defines a structure to hold the streaming input state and wait function.
+ */
+typedef struct vpx_input_wait_init {
+  /*! Wait callback. */
+  vpx_input_wait_cb wait_cb;
+
+  /*! Wait state. */
+  void *wait_state;
+} vpx_input_wait_init;
+
+/*!\brief Tiles reconstructed by VP9_SET_DECODE_TILE_REGION.
+ *
+ * Tile indices are inclusive. A negative col_end or row_end selects the last
+ * tile column or row of each frame.
+ */
+typedef struct vpx_tile_region {
+  int col_start; /**< First tile column to reconstruct. */
+  int col_end;   /**< Last tile column to reconstruct. */
+  int row_end;   /**< Last tile row to reconstruct. */
+} vpx_tile_region_t;
+
+/*!\brief Frame buffers to allocate with VP9_SET_FRAME_BUFFER_PREALLOC.
+ */
+typedef struct vpx_frame_buffer_prealloc {
+  unsigned int width;  /**< Largest frame width of the stream. */
+  unsigned int height; /**< Largest frame height of the stream. */
+  vpx_img_fmt_t fmt;   /**< Format of the frames, I420 if VPX_IMG_FMT_NONE. */
+  int num_buffers;     /**< Number of frame buffers, at most
+                            VP9_MAXIMUM_REF_BUFFERS +
+                            VPX_MAXIMUM_WORK_BUFFERS. */
+} vpx_frame_buffer_prealloc_t;
+
+/*!\brief Frame buffer memory reported by VP9D_GET_FRAME_BUFFER_STATS.
+ */
+typedef struct vpx_frame_buffer_stats {
+  size_t current_bytes; /**< Bytes allocated to frame buffers. */
+  size_t peak_bytes;    /**< Largest current_bytes since the first decode. */
+  int num_allocated;    /**< Frame buffers holding memory. */
+  int num_in_use;       /**< Frame buffers used by the decoder or output. */
+} vpx_frame_buffer_stats_t;
+
 /*!\cond */
 /*!\brief VP8 decoder control function parameter type
  *
@@ -179,6 +367,24 @@ VPX_CTRL_USE_TYPE(VP9_INVERT_TILE_DECODE_ORDER, int)
 #define VPX_CTRL_VP9_INVERT_TILE_DECODE_ORDER
 #define VPX_CTRL_VP9_DECODE_SVC_SPATIAL_LAYER
 VPX_CTRL_USE_TYPE(VP9_DECODE_SVC_SPATIAL_LAYER, int)
+#define VPX_CTRL_VP9_SET_DECODE_TILE_REGION
+VPX_CTRL_USE_TYPE(VP9_SET_DECODE_TILE_REGION, vpx_tile_region_t *)
+#define VPX_CTRL_VP9D_GET_VALID_REGION
+VPX_CTRL_USE_TYPE(VP9D_GET_VALID_REGION, vpx_image_rect_t *)
+#define VPX_CTRL_VP9_SET_FAST_PREVIEW
+VPX_CTRL_USE_TYPE(VP9_SET_FAST_PREVIEW, int)
+#define VPX_CTRL_VP9_SET_DROP_NON_REFERENCE
+VPX_CTRL_USE_TYPE(VP9_SET_DROP_NON_REFERENCE, int)
+#define VPX_CTRL_VP9_SET_KEY_FRAMES_ONLY
+VPX_CTRL_USE_TYPE(VP9_SET_KEY_FRAMES_ONLY, int)
+#define VPX_CTRL_VP9_SET_FRAME_BUFFER_PREALLOC
+VPX_CTRL_USE_TYPE(VP9_SET_FRAME_BUFFER_PREALLOC, vpx_frame_buffer_prealloc_t *)
+#define VPX_CTRL_VP9D_GET_FRAME_BUFFER_STATS
+VPX_CTRL_USE_TYPE(VP9D_GET_FRAME_BUFFER_STATS, vpx_frame_buffer_stats_t *)
+#define VPX_CTRL_VP9D_SET_INPUT_WAIT
+VPX_CTRL_USE_TYPE(VP9D_SET_INPUT_WAIT, vpx_input_wait_init *)
+#define VPX_CTRL_VP9D_GET_MODE_INFO
+VPX_CTRL_USE_TYPE(VP9D_GET_MODE_INFO, vpx_mode_info_t *)
 
 /*!\endcond */
 /*! @} - end defgroup vp8_decoder */
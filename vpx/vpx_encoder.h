@@ -160,6 +160,7 @@ enum vpx_codec_cx_pkt_kind {
   VPX_CODEC_SPATIAL_SVC_LAYER_SIZES, /**< Sizes for each layer in this frame*/
   VPX_CODEC_SPATIAL_SVC_LAYER_PSNR,  /**< PSNR for each layer in this frame*/
 #endif
+  VPX_CODEC_SPEED_PKT,       /**< Encode time and speed of this frame */
   VPX_CODEC_CUSTOM_PKT = 256 /**< Algorithm extensions  */
 };
 
@@ -191,6 +192,14 @@ typedef struct vpx_codec_cx_pkt {
       uint64_t sse[4];         /**< sum squared error, total/y/u/v */
       double psnr[4];          /**< PSNR, total/y/u/v */
     } psnr;                    /**< data for PSNR packet */
+    struct vpx_speed_pkt {
+      unsigned int encode_time; /**< Encode time in microseconds */
+      int speed;                /**< Speed the frame was encoded at */
+      int next_speed;           /**< Speed picked for the next frame */
+      /*!\brief Superblocks coded with faster searches to catch up with the
+       * target */
+      unsigned int late_blocks;
+    } speed; /**< data for speed packet */
     vpx_fixed_buf_t raw;       /**< data for arbitrary packets */
 // Spatial SVC is still experimental and may be removed before the next
 // ABI bump.
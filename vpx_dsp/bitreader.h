@@ -13,12 +13,14 @@
 
 #include <stddef.h>
 #include <limits.h>
+#include <string.h>
 
 #include "./vpx_config.h"
 #include "vpx_ports/mem.h"
 #include "vpx/vp8dx.h"
 #include "vpx/vpx_integer.h"
 #include "vpx_dsp/prob.h"
+#include "vpx_util/endian_inl.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -48,6 +50,9 @@ typedef struct {
 int vpx_reader_init(vpx_reader *r, const uint8_t *buffer, size_t size,
                     vpx_decrypt_cb decrypt_cb, void *decrypt_state);
 
+// Refills 'value' from 'buffer'. This handles every case, including the
+// decrypt callback and the end of the buffer, and is the slow path behind
+// vpx_reader_refill().
 void vpx_reader_fill(vpx_reader *r);
 
 const uint8_t *vpx_reader_find_end(vpx_reader *r);
@@ -70,35 +75,106 @@ static INLINE int vpx_reader_has_error(vpx_reader *r) {
   return r->count > BD_VALUE_SIZE && r->count < LOTS_OF_BITS;
 }
 
-static INLINE int vpx_read(vpx_reader *r, int prob) {
-  unsigned int bit = 0;
-  BD_VALUE value;
-  BD_VALUE bigsplit;
-  int count;
-  unsigned int range;
-  unsigned int split = (r->range * prob + (256 - prob)) >> CHAR_BIT;
+// Loads the next bytes of the stream into 'value' with one big-endian read.
+// Encrypted streams and the last sizeof(BD_VALUE) bytes of the buffer are
+// left to vpx_reader_fill().
+static INLINE void vpx_reader_refill(vpx_reader *r) {
+  const uint8_t *const buffer = r->buffer;
+
+  if (r->decrypt_cb == NULL &&
+      (size_t)(r->buffer_end - buffer) > sizeof(BD_VALUE)) {
+    const int shift = BD_VALUE_SIZE - CHAR_BIT - (r->count + CHAR_BIT);
+    const int bits = (shift & ~(CHAR_BIT - 1)) + CHAR_BIT;
+    BD_VALUE big_endian_values;
+    memcpy(&big_endian_values, buffer, sizeof(BD_VALUE));
+#if SIZE_MAX == 0xffffffffffffffffULL
+    big_endian_values = HToBE64(big_endian_values);
+#else
+    big_endian_values = HToBE32(big_endian_values);
+#endif
+    r->value |= (big_endian_values >> (BD_VALUE_SIZE - bits))
+                << (shift & (CHAR_BIT - 1));
+    r->count += bits;
+    r->buffer = buffer + (bits >> 3);
+  } else {
+    vpx_reader_fill(r);
+  }
+}
 
-  if (r->count < 0) vpx_reader_fill(r);
+// Decodes one bool with the coder state held in 'value', 'count' and 'range'
+// so that loops over many symbols can keep it in registers. 'r' is only
+// synced when a refill is needed.
+static INLINE int vpx_read_bool(vpx_reader *r, int prob, BD_VALUE *value,
+                                int *count, unsigned int *range) {
+  const unsigned int split = (*range * prob + (256 - prob)) >> CHAR_BIT;
+  const BD_VALUE bigsplit = (BD_VALUE)split << (BD_VALUE_SIZE - CHAR_BIT);
+  int bit = 0;
+  int shift;
+
+  if (*count < 0) {
+    r->value = *value;
+    r->count = *count;
+    vpx_reader_refill(r);
+    *value = r->value;
+    *count = r->count;
+  }
 
-  value = r->value;
-  count = r->count;
+  if (*value >= bigsplit) {
+    *range = *range - split;
+    *value = *value - bigsplit;
+    bit = 1;
+  } else {
+    *range = split;
+  }
 
-  bigsplit = (BD_VALUE)split << (BD_VALUE_SIZE - CHAR_BIT);
+  shift = vpx_norm[*range];
+  *range <<= shift;
+  *value <<= shift;
+  *count -= shift;
 
-  range = split;
+  return bit;
+}
 
-  if (value >= bigsplit) {
-    range = r->range - split;
-    value = value - bigsplit;
-    bit = 1;
+// Same as vpx_read_bool() but selects the new state with a mask instead of a
+// branch. This is faster for bits that are close to even and are only
+// accumulated into a value, like literals and the extra bits of a token.
+// When the decoded bit picks the next branch anyway, as in a tree walk, the
+// branch lets the CPU speculate ahead and vpx_read_bool() is faster.
+static INLINE int vpx_read_bool_nobranch(vpx_reader *r, int prob,
+                                         BD_VALUE *value, int *count,
+                                         unsigned int *range) {
+  const unsigned int split = (*range * prob + (256 - prob)) >> CHAR_BIT;
+  const BD_VALUE bigsplit = (BD_VALUE)split << (BD_VALUE_SIZE - CHAR_BIT);
+  BD_VALUE mask;
+  int shift;
+
+  if (*count < 0) {
+    r->value = *value;
+    r->count = *count;
+    vpx_reader_refill(r);
+    *value = r->value;
+    *count = r->count;
   }
 
-  {
-    register int shift = vpx_norm[range];
-    range <<= shift;
-    value <<= shift;
-    count -= shift;
-  }
+  // All ones when the bit is 1.
+  mask = (BD_VALUE)0 - (BD_VALUE)(*value >= bigsplit);
+  *value -= bigsplit & mask;
+  *range = split + ((*range - 2 * split) & (unsigned int)mask);
+
+  shift = vpx_norm[*range];
+  *range <<= shift;
+  *value <<= shift;
+  *count -= shift;
+
+  return (int)(mask & 1);
+}
+
+static INLINE int vpx_read(vpx_reader *r, int prob) {
+  BD_VALUE value = r->value;
+  int count = r->count;
+  unsigned int range = r->range;
+  const int bit = vpx_read_bool(r, prob, &value, &count, &range);
+
   r->value = value;
   r->count = count;
   r->range = range;
@@ -111,18 +187,35 @@ static INLINE int vpx_read_bit(vpx_reader *r) {
 }
 
 static INLINE int vpx_read_literal(vpx_reader *r, int bits) {
+  BD_VALUE value = r->value;
+  int count = r->count;
+  unsigned int range = r->range;
   int literal = 0, bit;
 
-  for (bit = bits - 1; bit >= 0; bit--) literal |= vpx_read_bit(r) << bit;
+  for (bit = bits - 1; bit >= 0; bit--)
+    literal |= vpx_read_bool_nobranch(r, 128, &value, &count, &range) << bit;
+
+  r->value = value;
+  r->count = count;
+  r->range = range;
 
   return literal;
 }
 
 static INLINE int vpx_read_tree(vpx_reader *r, const vpx_tree_index *tree,
                                 const vpx_prob *probs) {
+  BD_VALUE value = r->value;
+  int count = r->count;
+  unsigned int range = r->range;
   vpx_tree_index i = 0;
 
-  while ((i = tree[i + vpx_read(r, probs[i >> 1])]) > 0) continue;
+  while ((i = tree[i + vpx_read_bool(r, probs[i >> 1], &value, &count,
+                                     &range)]) > 0)
+    continue;
+
+  r->value = value;
+  r->count = count;
+  r->range = range;
 
   return -i;
 }
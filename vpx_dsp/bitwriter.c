@@ -26,6 +26,13 @@ void vpx_stop_encode(vpx_writer *br) {
 
   for (i = 0; i < 32; i++) vpx_write_bit(br, 0);
 
+  // Write out the whole bytes that are still pending.
+  if (br->count >= 0 && ((br->lowvalue >> (32 + br->count)) & 1))
+    vpx_writer_carry(br);
+
+  for (; br->count >= 0; br->count -= 8)
+    br->buffer[br->pos++] = (uint8_t)(br->lowvalue >> (24 + br->count));
+
   // Ensure there's no ambigous collision with any index marker bytes
   if ((br->buffer[br->pos - 1] & 0xe0) == 0xc0) br->buffer[br->pos++] = 0;
 }
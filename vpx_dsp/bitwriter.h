@@ -19,8 +19,11 @@
 extern "C" {
 #endif
 
+// The pending bits of the coder are kept in a 64-bit register and written out
+// 4 bytes at a time. A carry out of the register is only propagated into the
+// buffer when those bytes are written.
 typedef struct vpx_writer {
-  unsigned int lowvalue;
+  uint64_t lowvalue;
   unsigned int range;
   int count;
   unsigned int pos;
@@ -30,49 +33,54 @@ typedef struct vpx_writer {
 void vpx_start_encode(vpx_writer *bc, uint8_t *buffer);
 void vpx_stop_encode(vpx_writer *bc);
 
+// Adds the carry out of the pending bits to the bytes already written.
+static INLINE void vpx_writer_carry(vpx_writer *br) {
+  int x = br->pos - 1;
+
+  while (x >= 0 && br->buffer[x] == 0xff) {
+    br->buffer[x] = 0;
+    x--;
+  }
+
+  br->buffer[x] += 1;
+}
+
 static INLINE void vpx_write(vpx_writer *br, int bit, int probability) {
   unsigned int split;
   int count = br->count;
   unsigned int range = br->range;
-  unsigned int lowvalue = br->lowvalue;
-  register int shift;
+  uint64_t lowvalue = br->lowvalue;
+  int shift;
 
   split = 1 + (((range - 1) * probability) >> 8);
 
-  range = split;
-
-  if (bit) {
-    lowvalue += split;
-    range = br->range - split;
-  }
+  // Select the subinterval without a branch on the unpredictable bit.
+  lowvalue += split & (0u - !!bit);
+  range = bit ? range - split : split;
 
   shift = vpx_norm[range];
 
   range <<= shift;
+  lowvalue <<= shift;
   count += shift;
 
-  if (count >= 0) {
-    int offset = shift - count;
-
-    if ((lowvalue << (offset - 1)) & 0x80000000) {
-      int x = br->pos - 1;
-
-      while (x >= 0 && br->buffer[x] == 0xff) {
-        br->buffer[x] = 0;
-        x--;
-      }
-
-      br->buffer[x] += 1;
-    }
-
-    br->buffer[br->pos++] = (lowvalue >> (24 - offset));
-    lowvalue <<= offset;
-    shift = count;
-    lowvalue &= 0xffffff;
-    count -= 8;
+  // lowvalue holds 32 + count bits, with the carry above them. Once 4 whole
+  // bytes are pending they are written out together.
+  if (count >= 24) {
+    uint8_t *const dst = br->buffer + br->pos;
+    const uint32_t bytes = (uint32_t)(lowvalue >> count);
+
+    if ((lowvalue >> (32 + count)) & 1) vpx_writer_carry(br);
+
+    dst[0] = (uint8_t)(bytes >> 24);
+    dst[1] = (uint8_t)(bytes >> 16);
+    dst[2] = (uint8_t)(bytes >> 8);
+    dst[3] = (uint8_t)bytes;
+    br->pos += 4;
+    lowvalue &= ((uint64_t)1 << count) - 1;
+    count -= 32;
   }
 
-  lowvalue <<= shift;
   br->count = count;
   br->lowvalue = lowvalue;
   br->range = range;
@@ -0,0 +1,81 @@
+/*
+ *  Copyright (c) 2017 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VPX_PORTS_VPX_ATOMICS_H_
+#define VPX_PORTS_VPX_ATOMICS_H_
+
+#include "./vpx_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Minimal sequentially consistent atomic int, enough to publish progress
+// counters between threads without taking a lock. All operations are full
+// barriers.
+typedef struct vpx_atomic_int { volatile int value; } vpx_atomic_int;
+
+#if defined(__clang__) || \
+    (defined(__GNUC__) && \
+     (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+#define vpx_atomic_load_int_impl(p) __atomic_load_n(p, __ATOMIC_SEQ_CST)
+#define vpx_atomic_store_int_impl(p, v) __atomic_store_n(p, v, __ATOMIC_SEQ_CST)
+#define vpx_atomic_add_int_impl(p, v) __atomic_add_fetch(p, v, __ATOMIC_SEQ_CST)
+#elif defined(_MSC_VER)
+#include <intrin.h>  // NOLINT
+#define vpx_atomic_load_int_impl(p) _InterlockedOr((volatile long *)(p), 0)
+#define vpx_atomic_store_int_impl(p, v) \
+  _InterlockedExchange((volatile long *)(p), (long)(v))
+#define vpx_atomic_add_int_impl(p, v) \
+  (_InterlockedExchangeAdd((volatile long *)(p), (long)(v)) + (v))
+#elif defined(__GNUC__)
+// Older GCC only has the __sync builtins, which are full barriers.
+#define vpx_atomic_load_int_impl(p) \
+  __sync_add_and_fetch((volatile int *)(p), 0)
+#define vpx_atomic_store_int_impl(p, v) \
+  do {                                  \
+    __sync_synchronize();               \
+    *(p) = (v);                         \
+    __sync_synchronize();               \
+  } while (0)
+#define vpx_atomic_add_int_impl(p, v) __sync_add_and_fetch(p, v)
+#elif !CONFIG_MULTITHREAD
+#define vpx_atomic_load_int_impl(p) (*(p))
+#define vpx_atomic_store_int_impl(p, v) (*(p) = (v))
+#define vpx_atomic_add_int_impl(p, v) (*(p) += (v))
+#else
+#error "Atomic operations are not available for this compiler."
+#endif
+
+static INLINE void vpx_atomic_init(vpx_atomic_int *atomic, int value) {
+  atomic->value = value;
+}
+
+static INLINE void vpx_atomic_store(vpx_atomic_int *atomic, int value) {
+  vpx_atomic_store_int_impl(&atomic->value, value);
+}
+
+static INLINE int vpx_atomic_load(const vpx_atomic_int *atomic) {
+  return vpx_atomic_load_int_impl(&atomic->value);
+}
+
+static INLINE int vpx_atomic_add(vpx_atomic_int *atomic, int value) {
+  return vpx_atomic_add_int_impl(&atomic->value, value);
+}
+
+#undef vpx_atomic_load_int_impl
+#undef vpx_atomic_store_int_impl
+#undef vpx_atomic_add_int_impl
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // VPX_PORTS_VPX_ATOMICS_H_
@@ -96,6 +96,13 @@ static const arg_def_t svcdecodingarg = ARG_DEF(
     NULL, "svc-decode-layer", 1, "Decode SVC stream up to given spatial layer");
 static const arg_def_t framestatsarg =
     ARG_DEF(NULL, "framestats", 1, "Output per-frame stats (.csv format)");
+static const arg_def_t previewarg =
+    ARG_DEF(NULL, "preview", 1,
+            "Fast, lower quality decode scaled to 1/2 (1) or 1/4 (2) size");
+static const arg_def_t keyframesonlyarg =
+    ARG_DEF(NULL, "keyframes-only", 0, "Decode only key frames");
+static const arg_def_t dropnonrefarg = ARG_DEF(
+    NULL, "drop-non-reference", 0, "Drop frames no other frame references");
 
 static const arg_def_t *all_args[] = {
   &codecarg,          &use_yv12,         &use_i420,
@@ -108,7 +115,8 @@ static const arg_def_t *all_args[] = {
 #if CONFIG_VP9_HIGHBITDEPTH
   &outbitdeptharg,
 #endif
-  &svcdecodingarg,    &framestatsarg,    NULL
+  &svcdecodingarg,    &framestatsarg,    &previewarg,
+  &keyframesonlyarg,  &dropnonrefarg,    NULL
 };
 
 #if CONFIG_VP8_DECODER
@@ -520,6 +528,9 @@ static int main_loop(int argc, const char **argv_) {
   int frames_corrupted = 0;
   int dec_flags = 0;
   int do_scale = 0;
+  int preview = 0;
+  int key_frames_only = 0;
+  int drop_non_ref = 0;
   vpx_image_t *scaled_img = NULL;
 #if CONFIG_VP9_HIGHBITDEPTH
   vpx_image_t *img_shifted = NULL;
@@ -593,6 +604,14 @@ static int main_loop(int argc, const char **argv_) {
 #if CONFIG_VP9_DECODER
     else if (arg_match(&arg, &frameparallelarg, argi))
       frame_parallel = 1;
+    else if (arg_match(&arg, &previewarg, argi)) {
+      preview = arg_parse_uint(&arg);
+      do_scale = preview > 0;
+    } else if (arg_match(&arg, &keyframesonlyarg, argi)) {
+      key_frames_only = 1;
+    } else if (arg_match(&arg, &dropnonrefarg, argi)) {
+      drop_non_ref = 1;
+    }
 #endif
     else if (arg_match(&arg, &verbosearg, argi))
       quiet = 0;
@@ -741,6 +760,25 @@ static int main_loop(int argc, const char **argv_) {
       goto fail;
     }
   }
+  if (preview) {
+    if (vpx_codec_control(&decoder, VP9_SET_FAST_PREVIEW, preview)) {
+      fprintf(stderr, "Failed to set fast preview: %s\n",
+              vpx_codec_error(&decoder));
+      goto fail;
+    }
+  }
+  if (key_frames_only &&
+      vpx_codec_control(&decoder, VP9_SET_KEY_FRAMES_ONLY, 1)) {
+    fprintf(stderr, "Failed to set key frames only: %s\n",
+            vpx_codec_error(&decoder));
+    goto fail;
+  }
+  if (drop_non_ref &&
+      vpx_codec_control(&decoder, VP9_SET_DROP_NON_REFERENCE, 1)) {
+    fprintf(stderr, "Failed to set non-reference frame dropping: %s\n",
+            vpx_codec_error(&decoder));
+    goto fail;
+  }
   if (!quiet) fprintf(stderr, "%s\n", decoder.name);
 
 #if CONFIG_VP8_DECODER
@@ -875,6 +913,10 @@ static int main_loop(int argc, const char **argv_) {
               render_height = render_size[1];
             }
           }
+          if (preview) {
+            render_width = (render_width + (1 << preview) - 1) >> preview;
+            render_height = (render_height + (1 << preview) - 1) >> preview;
+          }
           scaled_img =
               vpx_img_alloc(NULL, img->fmt, render_width, render_height, 16);
           scaled_img->bit_depth = img->bit_depth;